@@ -27,12 +27,15 @@
  *  - Timer TCA0 driver added
  *      - System Clock (20MHz), 16 bit Timer, Requested Timeout 35us.
  *      - Enable Overflow Interrupt
+ *  - Timer TCB1 is used as a free running time base, and is set up in main()
+ *      (i.e. not by MCC).
  * 
  * N.B. Inverted Outputs on PF0 - PF1 is to allow for MOSFET inversion of lines.
  * 
  * Change Log
  * ----------
  * v1.0 - Initial release.
+ * v1.1 - Matrix row reads are pipelined, to overlap the row settle delay.
  *    
  */
 #include "mcc_generated_files/system/system.h"
@@ -62,6 +65,25 @@ const struct TMR_INTERFACE *Timer = &TCA0_Interface;
  */
 #define DebounceCount 0x14
 
+/*
+ * RowSettleUs defines the delay in microseconds, between driving a matrix row
+ * low and reading its columns.
+ * N.B. Rows are pipelined, so the next row is settling while the current row
+ *  is being processed. Only any remaining settle time is actually waited for.
+ * 
+ * Scan period (8 rows) is therefore reduced from:
+ *  8 x (RowSettleUs + row processing),  to:
+ *  8 x the longer of (RowSettleUs, or row processing) 
+ */
+#define RowSettleUs 10
+
+/*
+ * TimeBase is a free running 16 bit timer (TCB1) clocked at System Clock / 2.
+ * Used for timing short intervals (e.g. row settle delay), in TimeBase ticks.
+ */
+#define TimeBase TCB1
+#define TimeBase_TicksPerUs (F_CPU / 2000000UL)
+
 /*
  * IntervalCount is how many Clock cycles for each PS/2 transmission period.
  */
@@ -109,9 +131,45 @@ static volatile uint8_t PS2_ScanCodeBuffer_End   = 0;
 static const uint8_t PS2_Clock_bm  = PIN0_bm;
 static const uint8_t PS2_Data_bm = PIN1_bm;
 
+/*
+ * Drive a Keyboard matrix row low, ready for reading its columns.
+ * Time is noted, so that reading can wait for the row to settle.
+ */
+static uint16_t RowDrivenTime;
+
+static void scanRowDrive(uint8_t r) 
+{
+    PORTA.DIRSET = RowCol_bm[r];
+    PORTA.OUTCLR = RowCol_bm[r];
+    RowDrivenTime = TimeBase.CNT;
+}
+
+/*
+ * Read the columns of the (driven) Keyboard matrix row, once the row has 
+ * settled, then return the row to Input.
+ */
+static uint8_t scanRowRead(uint8_t r) 
+{
+    uint8_t matrix_row;
+
+    /* Wait for any remaining settle time */
+    while ((uint16_t)(TimeBase.CNT - RowDrivenTime) < (RowSettleUs * TimeBase_TicksPerUs))
+        ;
+    /* re-read Joystick to get Button Right & Left (1 is ON) */
+    matrix_row = PORTD.IN;
+    /* Return to Input for this row */
+    PORTA.DIRCLR = RowCol_bm[r];
+
+    return matrix_row;
+}
+
 /*
  * Scan our Keyboard matrix
  * De-bounce delay any detected changes, then store Scan Codes in ScanCodeBuffer
+ * 
+ * Row reads are pipelined, the next row is driven as soon as the current row
+ * is read, so that it settles while the current row is processed.
+ * N.B. Row 0 is driven at the end of the previous scan (or by main() at start).
  */
 static void scanKeyboard(void) 
 {
@@ -120,14 +178,11 @@ static void scanKeyboard(void)
     
     for (uint8_t r = 0; r < MatrixRows; r++)
     {
-        /* For each Row, read the row columns by row output low */
-        PORTA.DIRSET = RowCol_bm[r];
-        PORTA.OUTCLR = RowCol_bm[r];
-        _delay_us(10);
-        /* re-read Joystick to get Button Right & Left (1 is ON) */
-        matrix_row = PORTD.IN;
-        /* Return to Input for this row */
-        PORTA.DIRCLR = RowCol_bm[r];
+        /* For each Row, read the row columns (row is already output low) */
+        matrix_row = scanRowRead(r);
+
+        /* Drive the next row now, so it is settling while we process this one */
+        scanRowDrive((r + 1 < MatrixRows) ? r + 1 : 0);
         
         for (uint8_t c = 0; c < MatrixCols; c++)
         {    
@@ -339,6 +394,14 @@ int main(void)
             KeyswitchReleased[r][c] = true;
         }
     
+    /* Start TimeBase free running (periodic mode, maximum period) */
+    TimeBase.CCMP = 0xFFFF;
+    TimeBase.CTRLB = TCB_CNTMODE_INT_gc;
+    TimeBase.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+
+    /* Drive the first Keyboard matrix row, ready for the first scan */
+    scanRowDrive(0);
+    
     /* Let's do this forever! */
     while(1)
     {
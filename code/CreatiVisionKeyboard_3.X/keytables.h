@@ -0,0 +1,58 @@
+/*
+ * CreatiVision Keyboard key tables
+ * 
+ * GENERATED by tools/keytables.py from keylayout.txt - DO NOT EDIT!
+ * 
+ * Included by main.c (after MatrixRows / MatrixCols are defined).
+ */
+
+/*
+ * PS/2 make (key press) and break (key release) sequences for each
+ * Keyboard matrix Row / Column. First byte is the sequence length
+ * (0 if there is no key switch), followed by the bytes to send.
+ */
+#define PS2_KeyMake_Size 3
+#define PS2_KeyBreak_Size 4
+
+static const uint8_t PS2_KeyMake[MatrixRows][MatrixCols][PS2_KeyMake_Size]
+                        = {{{0x01,0x16,0x00},{0x01,0x1E,0x00},{0x01,0x26,0x00},{0x01,0x25,0x00},{0x01,0x2E,0x00},{0x01,0x36,0x00},{0x00,0x00,0x00},{0x00,0x00,0x00}},
+                           {{0x00,0x00,0x00},{0x01,0x15,0x00},{0x01,0x1D,0x00},{0x01,0x24,0x00},{0x01,0x2D,0x00},{0x01,0x2C,0x00},{0x01,0x14,0x00},{0x00,0x00,0x00}},
+                           {{0x02,0xE0,0x6B},{0x01,0x1C,0x00},{0x01,0x1B,0x00},{0x01,0x23,0x00},{0x01,0x2B,0x00},{0x01,0x34,0x00},{0x00,0x00,0x00},{0x00,0x00,0x00}},
+                           {{0x00,0x00,0x00},{0x01,0x1A,0x00},{0x01,0x22,0x00},{0x01,0x21,0x00},{0x01,0x2A,0x00},{0x01,0x32,0x00},{0x00,0x00,0x00},{0x01,0x59,0x00}},
+                           {{0x01,0x3D,0x00},{0x01,0x3E,0x00},{0x01,0x46,0x00},{0x01,0x45,0x00},{0x01,0x52,0x00},{0x01,0x4E,0x00},{0x00,0x00,0x00},{0x00,0x00,0x00}},
+                           {{0x01,0x35,0x00},{0x01,0x3C,0x00},{0x01,0x43,0x00},{0x01,0x44,0x00},{0x01,0x4D,0x00},{0x01,0x5A,0x00},{0x00,0x00,0x00},{0x00,0x00,0x00}},
+                           {{0x01,0x33,0x00},{0x01,0x3B,0x00},{0x01,0x42,0x00},{0x01,0x4B,0x00},{0x01,0x4C,0x00},{0x02,0xE0,0x74},{0x00,0x00,0x00},{0x00,0x00,0x00}},
+                           {{0x01,0x31,0x00},{0x01,0x3A,0x00},{0x01,0x41,0x00},{0x01,0x49,0x00},{0x01,0x4A,0x00},{0x01,0x29,0x00},{0x00,0x00,0x00},{0x00,0x00,0x00}}};
+
+static const uint8_t PS2_KeyBreak[MatrixRows][MatrixCols][PS2_KeyBreak_Size]
+                        = {{{0x02,0xF0,0x16,0x00},{0x02,0xF0,0x1E,0x00},{0x02,0xF0,0x26,0x00},{0x02,0xF0,0x25,0x00},{0x02,0xF0,0x2E,0x00},{0x02,0xF0,0x36,0x00},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x00,0x00,0x00,0x00},{0x02,0xF0,0x15,0x00},{0x02,0xF0,0x1D,0x00},{0x02,0xF0,0x24,0x00},{0x02,0xF0,0x2D,0x00},{0x02,0xF0,0x2C,0x00},{0x02,0xF0,0x14,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x03,0xE0,0xF0,0x6B},{0x02,0xF0,0x1C,0x00},{0x02,0xF0,0x1B,0x00},{0x02,0xF0,0x23,0x00},{0x02,0xF0,0x2B,0x00},{0x02,0xF0,0x34,0x00},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x00,0x00,0x00,0x00},{0x02,0xF0,0x1A,0x00},{0x02,0xF0,0x22,0x00},{0x02,0xF0,0x21,0x00},{0x02,0xF0,0x2A,0x00},{0x02,0xF0,0x32,0x00},{0x00,0x00,0x00,0x00},{0x02,0xF0,0x59,0x00}},
+                           {{0x02,0xF0,0x3D,0x00},{0x02,0xF0,0x3E,0x00},{0x02,0xF0,0x46,0x00},{0x02,0xF0,0x45,0x00},{0x02,0xF0,0x52,0x00},{0x02,0xF0,0x4E,0x00},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x02,0xF0,0x35,0x00},{0x02,0xF0,0x3C,0x00},{0x02,0xF0,0x43,0x00},{0x02,0xF0,0x44,0x00},{0x02,0xF0,0x4D,0x00},{0x02,0xF0,0x5A,0x00},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x02,0xF0,0x33,0x00},{0x02,0xF0,0x3B,0x00},{0x02,0xF0,0x42,0x00},{0x02,0xF0,0x4B,0x00},{0x02,0xF0,0x4C,0x00},{0x03,0xE0,0xF0,0x74},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}},
+                           {{0x02,0xF0,0x31,0x00},{0x02,0xF0,0x3A,0x00},{0x02,0xF0,0x41,0x00},{0x02,0xF0,0x49,0x00},{0x02,0xF0,0x4A,0x00},{0x02,0xF0,0x29,0x00},{0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00}}};
+
+/*
+ * Key switches fitted (valid keys), bit mask of columns for each row.
+ */
+static const uint8_t PS2_KeyValid_bm[MatrixRows]
+                        = {0x3F,0x7E,0x3F,0xBE,0x3F,0x3F,0x3F,0x3F};
+
+/*
+ * PS2_KeyCount = the number of key switches fitted.
+ * PS2_KeyIndex = a key number (0 to PS2_KeyCount - 1) for each key matrix
+ * Row / Column (or 0xFF if no key switch), for per key tables.
+ */
+#define PS2_KeyCount 48
+
+static const uint8_t PS2_KeyIndex[MatrixRows][MatrixCols]
+                        = {{   0,   1,   2,   3,   4,   5,0xFF,0xFF},
+                           {0xFF,   6,   7,   8,   9,  10,  11,0xFF},
+                           {  12,  13,  14,  15,  16,  17,0xFF,0xFF},
+                           {0xFF,  18,  19,  20,  21,  22,0xFF,  23},
+                           {  24,  25,  26,  27,  28,  29,0xFF,0xFF},
+                           {  30,  31,  32,  33,  34,  35,0xFF,0xFF},
+                           {  36,  37,  38,  39,  40,  41,0xFF,0xFF},
+                           {  42,  43,  44,  45,  46,  47,0xFF,0xFF}};
@@ -30,16 +30,69 @@
  *      - System Clock (20MHz)
  *          16 bit Timer,
  *          Requested Timeout 40us.
- *      - Enable Overflow Interrupt
+ *      - Enable Overflow Interrupt (unless PS2_DirectVector, see below)
+ *      - TCA0 Compare 0 Interrupt is used for PS/2 clock edges, and is set up
+ *          in main() and ISR(TCA0_CMP0_vect) (i.e. not enabled by MCC).
+ *  - Timer TCB1 is used as a free running time base, and is set up in main()
+ *      (i.e. not by MCC).
+ *  - Timer TCB0 is used for optional fixed rate Keyboard scanning, and is also
+ *      set up in main() (i.e. not by MCC).
+ *  - PD0 - PD7 pin change interrupts are used to wake from Keyboard idle, via
+ *      the MCC pins interrupt handlers (IO_PD0 - IO_PD7).
+ *  - PF1 (PS/2 Data) pin change interrupt is used to restart the stopped PS/2 
+ *      Timer, via the MCC pins interrupt handler (IO_PF1).
  * 
  * Change Log
  * ----------
  * v3.0 - Initial release.
+ * v3.1 - Key de-bouncing now processes a whole row at once (vertical counters).
+ *      - Unchanged and settled matrix rows are skipped when scanning.
+ *      - Matrix row reads are pipelined, to overlap the row settle delay.
+ *      - Optional fixed rate (Timer driven) matrix scanning, with de-bounce 
+ *          time defined in microseconds.
+ *      - Optional eager de-bounce mode, for minimum key press latency.
+ *      - Optional adaptive (learnt per key switch) de-bounce intervals, which
+ *          the Host can read (Diagnostics page 3).
+ *      - Keyboard idles (sleeps) while no keys are pressed, until a key press.
+ *      - PS/2 key tables are generated from the key layout (keylayout.txt).
+ *      - Matrix positions with no key switch are never de-bounced.
+ *      - Ghost key patterns are detected, and hold back new key presses, 
+ *          and are counted (Diagnostics page 4).
+ *      - Key state query functions (keyIsDown() etc.), for the packed key state.
+ *      - Optional scan period and jitter statistics, which the Host can read
+ *          using the (vendor specific) Diagnostics command 0xE1.
+ *      - PS/2 clock edges are issued by a Timer compare interrupt, rather than
+ *          busy-waiting (for the data to clock delay) in the Timer interrupt.
+ *      - Each byte sent is built into a whole PS/2 frame (with parity) first,
+ *          then shifted out a bit at a time.
+ *      - Optional direct TCA0 overflow ISR for PS/2, bypassing the MCC callback.
+ *      - PS/2 protocol is now an explicit state machine (with a state table),
+ *          with its worst case execution time checked by the build.
+ *      - PS/2 Timer is stopped while there is nothing to send and the bus is
+ *          idle (restarted by a byte to send, or a Host Request To Send).
+ *      - PS/2 clock rate (10kHz - 16.7kHz) can be set by the Host, using the
+ *          (vendor specific) Clock Rate command 0xE2, including auto-probe.
+ *      - Resend (0xFE) command now resends the last byte sent.
+ *      - Command responses are sent before (rather than discarding) any
+ *          ScanCodes waiting to be sent. Echo (0xEE) command is answered.
+ *      - PS/2 Buffers are lock free (single producer / consumer), so adding 
+ *          ScanCodes no longer disables interrupts.
+ *      - Key Events (a byte per key press / release) are queued, rather than 
+ *          their ScanCode sequences, and only expanded as they are sent.
+ *      - PS/2 buffer overflow drops whole Key Events only (never part of a 
+ *          sequence), and drops are counted (Diagnostics page 2). Reset 
+ *          (0xFF) command discards Key Events, including any part sent.
+ *      - Optional PS/2 buffer high watermarks, and Key Event latency samples
+ *          (Diagnostics page 2).
+ *      - PS/2 buffer sizes are configured (and reduced to 32 Key Events, and
+ *          8 Command bytes), and const tables are kept in flash (no longer
+ *          copied to SRAM). Builds report the SRAM / flash used per symbol.
  *    
  */
 #include "mcc_generated_files/system/system.h"
 #include "util/atomic.h"
 #include "util/delay.h"
+#include "avr/sleep.h"
 
 const struct TMR_INTERFACE *Timer = &TCA0_Interface;
 
@@ -49,454 +102,1944 @@ const struct TMR_INTERFACE *Timer = &TCA0_Interface;
 #define MatrixRows 8
 #define MatrixCols 8
 
+/*
+ * Build options follow. Each can also be set from the compiler command line
+ * (e.g. -DDebounceEager=1), as the host simulation (tools/hostsim) does.
+ */
+
+/*
+ * ScanTimerDriven set to 1 scans the Keyboard matrix at a fixed rate, driven
+ * by Timer TCB0, rather than continuously from the main() loop.
+ * Each ScanTimerPeriodUs, either one matrix row is scanned 
+ * (ScanTimerRowPerPeriod 1), or the full matrix is scanned (0).
+ * DebounceUs is then the de-bounce interval in microseconds, so de-bounce 
+ * time no longer depends on how busy we are (e.g. with PS/2 traffic).
+ */
+#ifndef ScanTimerDriven
+#define ScanTimerDriven 0
+#endif
+#ifndef ScanTimerPeriodUs
+#define ScanTimerPeriodUs 125
+#endif
+#ifndef ScanTimerRowPerPeriod
+#define ScanTimerRowPerPeriod 1
+#endif
+#ifndef DebounceUs
+#define DebounceUs 5000
+#endif
+
 /*
  * DebounceCount is how many Keyboard Scans for a de-bounce interval.
+ * DebounceCountBits is the width of the (vertical) de-bounce counters, the
+ * fewest bits that can hold DebounceCount (e.g. 5 bits for the default 20,
+ * or 6 bits for ScanTimerDriven whole matrix scans, 5000us / 125us = 40).
  */
+#if ScanTimerDriven
+#if ScanTimerRowPerPeriod
+#define ScanMatrixPeriodUs (ScanTimerPeriodUs * MatrixRows)
+#else
+#define ScanMatrixPeriodUs ScanTimerPeriodUs
+#endif
+#define DebounceCount (DebounceUs / ScanMatrixPeriodUs)
+#else
+#ifndef DebounceCount
 #define DebounceCount 20
+#endif
+#endif
+
+#if (DebounceCount < 2)
+#define DebounceCountBits 1
+#elif (DebounceCount < 4)
+#define DebounceCountBits 2
+#elif (DebounceCount < 8)
+#define DebounceCountBits 3
+#elif (DebounceCount < 16)
+#define DebounceCountBits 4
+#elif (DebounceCount < 32)
+#define DebounceCountBits 5
+#elif (DebounceCount < 64)
+#define DebounceCountBits 6
+#elif (DebounceCount < 128)
+#define DebounceCountBits 7
+#else
+#define DebounceCountBits 8
+#endif
+
+/*
+ * DebounceEager set to 1 reports a key change as soon as it is first seen, 
+ * then locks the key out for the de-bounce interval (to ignore its chatter).
+ * Otherwise (0 = default), a key change is only reported once the key has 
+ * been stable for the de-bounce interval.
+ * 
+ * N.B. Key press (and release) latency is therefore:
+ *  Deferred (0): DebounceCount Keyboard Scans.
+ *  Eager (1): under 1 Keyboard Scan (but is less immune to electrical noise),
+ *      plus 1 Keyboard Scan for key presses with GhostDetect.
+ */
+#ifndef DebounceEager
+#define DebounceEager 0
+#endif
+
+/*
+ * DebounceAdaptive set to 1 learns a de-bounce interval for each key switch, 
+ * from how long its chatter is measured to look stable before bouncing again.
+ * A key's interval (in Keyboard Scans) is raised to its longest measured 
+ * chatter plus DebounceAdaptiveMargin, and is lowered by one after 
+ * DebounceAdaptiveSettled key changes in a row without any chatter. 
+ * Intervals are kept between DebounceAdaptiveMin and DebounceCount.
+ * N.B. Only for the (default) deferred de-bounce mode.
+ */
+#ifndef DebounceAdaptive
+#define DebounceAdaptive 0
+#endif
+#ifndef DebounceAdaptiveMin
+#define DebounceAdaptiveMin 4
+#endif
+#ifndef DebounceAdaptiveMargin
+#define DebounceAdaptiveMargin 2
+#endif
+#ifndef DebounceAdaptiveSettled
+#define DebounceAdaptiveSettled 8
+#endif
+
+#if (DebounceCount < 1)
+#error "DebounceUs is shorter than a Keyboard matrix scan"
+#endif
+
+#if (DebounceCount > 255)
+#error "DebounceUs is too long for 8 bit de-bounce counters"
+#endif
+
+#if DebounceAdaptive
+#if DebounceEager
+#error "DebounceAdaptive is not supported with DebounceEager"
+#endif
+#if ((DebounceAdaptiveMin < 1) || (DebounceAdaptiveMin > DebounceCount))
+#error "DebounceAdaptiveMin must be between 1 and DebounceCount"
+#endif
+#if ((DebounceCount > 31) || (DebounceAdaptiveSettled > 8))
+#error "DebounceAdaptive intervals are packed in 5 bits (DebounceCount up to 31), settled counts in 3 bits"
+#endif
+#endif
+
+/*
+ * RowSettleUs defines the delay in microseconds, between driving a matrix row
+ * low and reading its columns.
+ * N.B. Rows are pipelined, so the next row is settling while the current row
+ *  is being processed. Only any remaining settle time is actually waited for.
+ * 
+ * Scan period (8 rows, settled matrix) is therefore reduced from:
+ *  8 x (RowSettleUs + row processing) + processCommand(),  to:
+ *  8 x the longer of (RowSettleUs, or row processing) 
+ * Measured by ScanStats (Diagnostics page 0) in the host simulation, with a
+ * key held and another chattering, the mean scan period is 89.6us (89.9us 
+ * unpipelined). The simulation only counts time for register accesses, not 
+ * the row processing itself, which is just what pipelining overlaps, so the
+ * saving on the AVR is up to 8 x row processing more (not yet measured).
+ */
+#ifndef RowSettleUs
+#define RowSettleUs 10
+#endif
+
+/*
+ * KeyboardIdleSleep set to 1 stops scanning the Keyboard matrix while no keys 
+ * are pressed. Instead all rows are driven low, so any key press will cause a
+ * column pin change interrupt, and the CPU sleeps (Idle) until then.
+ */
+#ifndef KeyboardIdleSleep
+#define KeyboardIdleSleep 1
+#endif
+
+/*
+ * GhostDetect set to 1 checks the Keyboard matrix for ghost key patterns once
+ * per full scan. With no diodes, pressing keys on 2 rows that share a column,
+ * where one of these rows has another key pressed, makes other (phantom) keys 
+ * appear pressed. While the pattern persists, no new key presses are 
+ * confirmed (key releases still are), and each new pattern is counted.
+ * N.B. With DebounceEager, key presses are held for one full scan, so that
+ *  the ghost pattern they (or their phantom keys) make is detected first.
+ */
+#ifndef GhostDetect
+#define GhostDetect 1
+#endif
+
+/*
+ * ScanStats set to 1 measures the period of every full Keyboard matrix scan, 
+ * against TimeBase. The minimum, maximum and mean scan period are kept, along 
+ * with a histogram of scan jitter (change in period from the previous scan).
+ * These can be read by the Host, using our Diagnostics command (0xE1).
+ */
+#ifndef ScanStats
+#define ScanStats 1
+#endif
+
+/*
+ * TimeBase is a free running 16 bit timer (TCB1) clocked at System Clock / 2.
+ * Used for timing short intervals (e.g. row settle delay), in TimeBase ticks.
+ */
+#define TimeBase TCB1
+#define TimeBase_TicksPerUs (F_CPU / 2000000UL)
+
+/*
+ * ScanTimer is the Timer (TCB0) for ScanTimerDriven matrix scanning, also
+ * clocked at System Clock / 2 (so ScanTimerPeriodUs can be up to 6553us).
+ */
+#define ScanTimer TCB0
+
+#if ScanTimerDriven
+#if ((ScanTimerPeriodUs * TimeBase_TicksPerUs) > 0x10000)
+#error "ScanTimerPeriodUs is too long for ScanTimer"
+#endif
+#if (ScanTimerPeriodUs < (RowSettleUs * (ScanTimerRowPerPeriod ? 1 : MatrixRows)))
+#error "ScanTimerPeriodUs is too short to scan the Keyboard matrix"
+#endif
+#endif
+
+/*
+ * PS/2 clock rate, in 100Hz units (PS2_ClockRateMin - PS2_ClockRateMax, i.e. 
+ * 10kHz - 16.7kHz). The Timer (TCA0, clocked at System Clock) interrupts every
+ * half PS/2 clock cycle, so its period is set from the clock rate, between 
+ * frames. PS2_ClockRateDefault is the MCC set Timer period (40us).
+ * N.B. The period is rounded up, so the clock rate is never over the rate set
+ *  (i.e. never over the PS/2 maximum 16.7kHz).
+ * The Host can change the clock rate, using our Clock Rate command (0xE2).
+ * 
+ * The delay between Data transition (or sampling), and clock edge transition 
+ * is a quarter of the half clock cycle (e.g. 10us at 12.5kHz). Clock edges 
+ * are issued by the Timer compare 0 interrupt, so CMP0 is set to this delay.
+ * 
+ * Clock rate auto-probe steps the clock rate up by PS2_ClockProbeStep, after 
+ * every PS2_ClockProbeBytes bytes sent without the Host requesting a Resend.
+ * A Resend request steps it back down, and ends the auto-probe.
+ */
+#define PS2_ClockRateMin 100
+#define PS2_ClockRateMax 167
+#define PS2_ClockRateDefault 125
+#define PS2_ClockProbeStep 5
+#define PS2_ClockProbeBytes 32
+#define PS2_ClockHalfPeriodTicks(rate) ((F_CPU + (200UL * (rate)) - 1) / (200UL * (rate)))
+
+/*
+ * PS2_DirectVector set to 1 runs the PS/2 Timer Interrupt code directly as 
+ * ISR(TCA0_OVF_vect), rather than as a callback from the MCC TCA0 driver ISR.
+ * Calling a callback (an indirect call) makes the ISR save and restore all 
+ * the call-clobbered registers, whether used or not. Directly, the ISR only 
+ * saves the registers it uses. The saving is estimated (not yet measured) at
+ * some 50 cycles (2.5us) per interrupt: the 12 call-clobbered registers 
+ * (r18 - r27, r30, r31) at 3 cycles each (push and pop), the MCC ISR's load
+ * of the callback pointer (two lds) and its NULL test, and the indirect call
+ * and return. Less any of those registers the Timer Interrupt code uses
+ * anyway, and more for any other registers the MCC ISR saves. To measure it,
+ * compare the worst cases tools/isrwcet.py reports, building with each 
+ * setting.
+ * N.B. Requires "Enable Overflow Interrupt" to be disabled in MCC (so MCC
+ *  does not generate its own TCA0 overflow ISR). It is enabled in main().
+ */
+#ifndef PS2_DirectVector
+#define PS2_DirectVector 0
+#endif
+
+/*
+ * PS2_TimerIdleStop set to 1 stops the PS/2 Timer (TCA0) while there is 
+ * nothing to send and the PS/2 bus is idle, rather than interrupting every 
+ * 40us (some 25,000 interrupts per second) to check for something to do.
+ * The Timer is restarted by adding a byte to send, or by a Host Request To 
+ * Send (PS/2 Data line falling edge pin change interrupt).
+ */
+#ifndef PS2_TimerIdleStop
+#define PS2_TimerIdleStop 1
+#endif
+
+/*
+ * PS2_QueueStats set to 1 keeps the high watermark (most values ever waiting)
+ * of each PS/2 buffer, and samples Key Event latency (time from being queued,
+ * until its first ScanCode is sent, for one Key Event at a time, to the 
+ * nearest Timer interrupt). Along with the buffer overflow counts,
+ * these can be read by the Host, using our Diagnostics command (0xE1), for
+ * sizing the buffers by measurement.
+ */
+#ifndef PS2_QueueStats
+#define PS2_QueueStats 1
+#endif
+
+/*
+ * PS/2 Buffer sizes, in bytes (each must be a power of 2, up to 128). 
+ * Diagnostics page 2 reports each buffer's high watermark and overflow count,
+ * for sizing them by measurement.
+ *  PS2_KeyEventBuffer_Size = Key Events waiting to be sent (a byte per key
+ *      press or release, which takes some 2 - 3ms to send).
+ *  PS2_ResponseBuffer_Size = Command responses waiting to be sent. Must hold 
+ *      the largest Diagnostics page, plus its Acknowledges (27 bytes, or 51 
+ *      bytes with DebounceAdaptive).
+ *  PS2_CommandBuffer_Size = Host Commands / Data received, waiting to be 
+ *      processed. The Host waits for each byte's Acknowledge before sending
+ *      the next, so only one or two are ever waiting.
+ */
+#ifndef PS2_KeyEventBuffer_Size
+#define PS2_KeyEventBuffer_Size 32
+#endif
+#ifndef PS2_ResponseBuffer_Size
+#if DebounceAdaptive
+#define PS2_ResponseBuffer_Size 64
+#else
+#define PS2_ResponseBuffer_Size 32
+#endif
+#endif
+#ifndef PS2_CommandBuffer_Size
+#define PS2_CommandBuffer_Size 8
+#endif
+
+/*
+ * PS/2 key tables, generated from the Keyboard key layout (keylayout.txt).
+ * PS2_KeyMake / PS2_KeyBreak = the byte sequences to send for each key
+ * matrix Row / Column. Rows are PORTA, Columns are PORTD 
+ */
+#include "keytables.h"
+
+/* 
+ * KeyswitchDebounce = the incrementing de-bounce counts, as "vertical" counters.
+ *      Each row holds DebounceCountBits bytes, with byte b holding bit b of 
+ *      the count for each of the 8 columns (column c is bit c of each byte).
+ *      This allows a whole row to be de-bounced with a few byte operations.
+ * KeyswitchReleased = bit set if key switch is released (open), or clear if closed.
+ *      One byte per row, column c is bit c (same as the PORTD.IN bit).
+ *      This packed bitmap is THE de-bounced key state, query it using the 
+ *      key state functions below (keyIsDown() etc.).
+ * 
+ * N.B. This is 48 bytes of de-bounce state (with 5 bit counts), rather than 
+ *  128 bytes when holding a count byte and a bool for each of the 64 matrix
+ *  positions.
+ */ 
+static uint8_t KeyswitchDebounce[MatrixRows][DebounceCountBits];
+static uint8_t KeyswitchReleased[MatrixRows];
+
+#if DebounceAdaptive
+/*
+ * KeyswitchWindow = the learnt de-bounce interval for each key switch (bits 
+ *      0-4), and its count of settled key changes without chatter (bits 5-7).
+ *      Indexed by key number (PS2_KeyIndex), so only fitted keys use RAM.
+ * KeyswitchWindowBits = the learnt de-bounce intervals, as "vertical" values 
+ *      (in the same layout as KeyswitchDebounce, for comparing with the counts).
+ */
+#define KeyswitchWindow_gm  0x1F
+#define KeyswitchSettled_gm 0xE0
+#define KeyswitchSettled_1  0x20
+static uint8_t KeyswitchWindow[PS2_KeyCount];
+static uint8_t KeyswitchWindowBits[MatrixRows][DebounceCountBits];
+#endif
+
+/*
+ * KeyswitchLastRow = the last PORTD.IN value read for each row.
+ * KeyswitchInFlight = bit set for each column that is currently de-bouncing.
+ *      A row that reads the same as last time, with nothing de-bouncing, 
+ *      is already settled so needs no further processing.
+ */
+static uint8_t KeyswitchLastRow[MatrixRows];
+static uint8_t KeyswitchInFlight[MatrixRows];
+
+#if GhostDetect
+/*
+ * KeyswitchGhosting = true while a ghost key pattern is detected.
+ * KeyswitchRescan = true for a full scan after ghosting ends, so that settled
+ *      rows are processed again (to confirm any key presses held back).
+ * KeyswitchGhostCount = the number of ghost key patterns detected.
+ */
+static bool KeyswitchGhosting = false;
+static bool KeyswitchRescan = false;
+static uint16_t KeyswitchGhostCount = 0;
+
+#if DebounceEager
+/*
+ * KeyswitchPressHeld = bit set for each column with a key press first read
+ *      in the last scan, held until ghostDetect() has checked that scan.
+ */
+static uint8_t KeyswitchPressHeld[MatrixRows];
+#endif
+#endif
+
+/*
+ * PORT bit mask for each row or column
+ */
+static const uint8_t RowCol_bm[MatrixRows] 
+                        = {PIN0_bm,PIN1_bm,PIN2_bm,PIN3_bm,PIN4_bm,PIN5_bm,PIN6_bm,PIN7_bm};
+
+/*
+ * Key state functions (from the de-bounced key state, KeyswitchReleased)
+ * Keys are identified by their matrix position, KeyPosition(Row, Column).
+ * To iterate all keys down:
+ *  for (p = keyFirstDown(); p != KeyNone; p = keyNextDown(p + 1))
+ */
+#define KeyPosition(r, c) (((r) * MatrixCols) + (c))
+#define KeyPositionRow(p) ((p) / MatrixCols)
+#define KeyPositionCol(p) ((p) % MatrixCols)
+#define KeyNone 0xFF
+
+/* Is the key down (pressed)? */
+static inline bool keyIsDown(uint8_t position) 
+{
+    return !(KeyswitchReleased[KeyPositionRow(position)] & RowCol_bm[KeyPositionCol(position)]);
+}
+
+/* How many keys are down? */
+static inline uint8_t keyCountDown(void) 
+{
+    static const uint8_t nibbleBits[16] = {0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
+    uint8_t count = 0;
+    uint8_t down;
+
+    for (uint8_t r = 0; r < MatrixRows; r++)
+    {
+        down = ~KeyswitchReleased[r];
+        count += nibbleBits[down & 0x0F] + nibbleBits[down >> 4];
+    }
+    return count;
+}
+
+/* Which is the first key down, at or after position? (KeyNone if none) */
+static inline uint8_t keyNextDown(uint8_t position) 
+{
+    uint8_t down;
+
+    for (uint8_t r = KeyPositionRow(position); r < MatrixRows; r++)
+    {
+        down = (uint8_t)~KeyswitchReleased[r] >> KeyPositionCol(position);
+        for (; down; down >>= 1, position++)
+            if (down & 0x01) return position;
+        position = KeyPosition(r + 1, 0);
+    }
+    return KeyNone;
+}
+
+/* Which is the first key down? (KeyNone if none) */
+static inline uint8_t keyFirstDown(void) 
+{
+    return keyNextDown(0);
+}
+
+/*
+ * PS/2 Buffers are single producer, single consumer rotating buffers, so no 
+ * interrupt masking is needed. Only the producer writes _End (once a value is
+ * in the buffer), and only the consumer writes _Start (once a value is used).
+ * Both count up freely (wrapping at 256), and are masked (_Mask) to index the
+ * buffer, so buffer sizes must be a power of 2 (up to 128).
+ * A buffer is empty when _Start == _End, and full when (_End - _Start) == _Size,
+ * and a full buffer drops the newest value (as only the consumer can drop the
+ * oldest).
+ */
+
+/*
+ * PS/2 Keyboard Key Event Transmission Buffer
+ * Rotating buffer containing the Key Events to send (from main() to the ISR).
+ * A Key Event is one byte, the key's matrix position (KeyPosition) and whether
+ * it's a break (release). The ISR only expands it into the key's make / break
+ * ScanCode sequence (from the key tables) as it sends it, so each key stroke
+ * takes one byte here, rather than up to three.
+ * PS2_KeyEventBufferFlush is set (by the Reset command) to have the ISR 
+ * discard the Key Events not yet sent, before it sends the Reset's responses.
+ * N.B. That includes a Key Event part sent (e.g. a break after its E0), which
+ *  is the one time a sequence is split. The Host's Reset restarts its ScanCode
+ *  decoding, so the rest would otherwise arrive as a phantom (E0 FA AA F0 74).
+ */
+#define PS2_KeyEventBreak_bm     0x80
+#define PS2_KeyEventPosition_gm  0x7F
+#define PS2_KeyEventBuffer_Mask (PS2_KeyEventBuffer_Size - 1)
+static volatile uint8_t PS2_KeyEventBuffer[PS2_KeyEventBuffer_Size];
+static volatile uint8_t PS2_KeyEventBuffer_Start = 0;
+static volatile uint8_t PS2_KeyEventBuffer_End   = 0;
+static volatile bool PS2_KeyEventBufferFlush = false;
+
+#if ((MatrixRows * MatrixCols) > (PS2_KeyEventPosition_gm + 1))
+#error "Keyboard matrix is too large for a Key Event position"
+#endif
+
+/*
+ * PS/2 Keyboard Command Response Transmission Buffer
+ * Rotating buffer containing the Command responses to send (e.g. FA, AA, 
+ * AB 83, EE). Responses are always sent before any (more) Key Events, and 
+ * Key Events also wait while a received Command is still to be processed.
+ */
+#define PS2_ResponseBuffer_Mask (PS2_ResponseBuffer_Size - 1)
+#if PS2_ResponseBuffer_Size < 27
+#error "PS2_ResponseBuffer_Size is too small for Diagnostics page 0 (scan statistics, 27 bytes)"
+#endif
+#if DebounceAdaptive && (PS2_ResponseBuffer_Size < (2 + 1 + PS2_KeyCount))
+#error "PS2_ResponseBuffer_Size is too small for Diagnostics page 3 (learnt de-bounce intervals)"
+#endif
+static volatile uint8_t PS2_ResponseBuffer[PS2_ResponseBuffer_Size];
+static volatile uint8_t PS2_ResponseBuffer_Start = 0;
+static volatile uint8_t PS2_ResponseBuffer_End   = 0;
+
+/*
+ * PS/2 Host Command Receive Buffer
+ * Rotating buffer containing the Host Commands / Data received (from the ISR
+ * to main()).
+ */
+#define PS2_CommandBuffer_Mask (PS2_CommandBuffer_Size - 1)
+static volatile uint8_t PS2_CommandBuffer[PS2_CommandBuffer_Size];
+static volatile uint8_t PS2_CommandBuffer_Start = 0;
+static volatile uint8_t PS2_CommandBuffer_End   = 0;
+
+#if ((PS2_KeyEventBuffer_Size & PS2_KeyEventBuffer_Mask) || (PS2_KeyEventBuffer_Size > 128) \
+    || (PS2_ResponseBuffer_Size & PS2_ResponseBuffer_Mask) || (PS2_ResponseBuffer_Size > 128) \
+    || (PS2_CommandBuffer_Size & PS2_CommandBuffer_Mask) || (PS2_CommandBuffer_Size > 128))
+#error "PS/2 Buffer sizes must be a power of 2 (up to 128)"
+#endif
+
+/*
+ * PS/2 Buffer overflow counts (values dropped, as their buffer was full)
+ * N.B. PS2_CommandDropCount is counted by the ISR, so is 8 bit (saturating)
+ *  for main() to read it atomically.
+ */
+static uint16_t PS2_KeyEventDropCount = 0;
+static uint16_t PS2_ResponseDropCount = 0;
+static volatile uint8_t PS2_CommandDropCount = 0;
+
+#if PS2_QueueStats
+/*
+ * PS/2 Buffer statistics
+ * N.B. PS2_CommandHighWater is kept by the ISR.
+ * 
+ * Key Event latency is sampled, one Key Event at a time. main() arms a sample
+ * (PS2_LatencySampling) as it queues a Key Event. The ISR then counts its
+ * interrupts (half PS/2 clock cycles) until it starts sending that Key Event 
+ * (PS2_LatencyDone), and main() converts the count to us, for the statistics.
+ * So it's an approximation: Key Events queued while a sample is in flight 
+ * aren't measured, and each sample is to the nearest interrupt (40us at the
+ * default clock rate). Timing every Key Event would take a timestamp per 
+ * buffer slot, and a timer that doesn't wrap within the longest wait.
+ * N.B. Time while the Timer is stopped isn't counted. That is while a received
+ *  Command waits to be processed by main() (as Key Events wait behind it), so
+ *  a Key Event queued then is reported that much sooner. TimeBase (which wraps
+ *  every 6.5ms) can't time the longest waits (some 100ms for a full buffer).
+ */
+#define PS2_LatencyIdle 0
+#define PS2_LatencySampling 1
+#define PS2_LatencyDone 2
+
+static uint8_t PS2_KeyEventHighWater = 0;
+static uint8_t PS2_ResponseHighWater = 0;
+static volatile uint8_t PS2_CommandHighWater = 0;
+static volatile uint8_t PS2_LatencyState = PS2_LatencyIdle;
+static volatile uint8_t PS2_LatencyEvent = 0;  /* KeyEventBuffer_End of sample */
+static volatile uint16_t PS2_LatencyTicks = 0;
+static uint16_t PS2_LatencyCount = 0;
+static uint16_t PS2_LatencyMin = 0xFFFF;
+static uint16_t PS2_LatencyMax = 0;
+#endif
+
+/*
+ * PS/2 PORT PIN Bit Mask (bm) Definitions (PORTF is currently used)
+ * 
+ * N.B. PS/2 Clock & Data lines are open collector, so are driven low by 
+ *  setting the pin to Output (OUT is always low), and released by setting it
+ *  to Input. Peripheral outputs (TCB, CCL LUT, USART) instead drive their 
+ *  pins high as well as low, and none of them can be routed to PF0 / PF1 on
+ *  the AVR EA. So PS/2 framing can't be offloaded to the Timers, Event System
+ *  and CCL with this PCB, and the CPU (Timer Interrupt) sets each line state.
+ */
+static const uint8_t PS2_Clock_bm  = PIN0_bm;
+static const uint8_t PS2_Data_bm = PIN1_bm;
+
+/*
+ * PS/2 clock rate state
+ * PS2_ClockHalfPeriod = Timer ticks for the clock rate (used by the ISR).
+ * PS2_SentCount = bytes sent (incremented by the ISR), for auto-probe.
+ * PS2_LastSent = the last byte sent (by the ISR), for Resend.
+ */
+static uint8_t PS2_ClockRate = PS2_ClockRateDefault;
+static bool PS2_ClockProbe = false;
+static volatile uint16_t PS2_ClockHalfPeriod = PS2_ClockHalfPeriodTicks(PS2_ClockRateDefault);
+static volatile uint8_t PS2_SentCount = 0;
+static volatile uint8_t PS2_LastSent = 0;
+static uint16_t PS2_ResendCount = 0;
+
+#if PS2_TimerIdleStop
+/*
+ * Function to Start the PS/2 Timer, if stopped
+ * N.B. Called after adding a byte to send, so the Timer Interrupt can't be 
+ *  stopping the Timer meanwhile (it only stops with nothing to send).
+ */
+static void ps2TimerStart(void) 
+{
+    if (!(TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm))
+    {  /* No more PS/2 Data line (PF1) falling edge interrupts */
+        PORTF.PIN1CTRL = PORT_PULLUPEN_bm;
+
+        /* Restart a whole Timer period from now */
+        TCA0.SINGLE.CNT = 0;
+        TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm | TCA_SINGLE_CMP0_bm;
+        TCA0.SINGLE.CTRLA |= TCA_SINGLE_ENABLE_bm;
+    }
+}
+
+/*
+ * Function to Stop the PS/2 Timer, while idle (only from the Timer Interrupt)
+ * N.B. Always inlined, as a call from the Timer Interrupt costs its call and 
+ *  return, and (with PS2_DirectVector) saving all the call-clobbered registers.
+ */
+static inline __attribute__((always_inline)) void ps2TimerStop(void) 
+{
+    /* Enable PS/2 Data line (PF1) falling edge interrupt, for a Host RTS */
+    PORTF.PIN1CTRL = PORT_PULLUPEN_bm | PORT_ISC_FALLING_gc;
+
+    /* Unless the Data line is already low (as there'd be no edge!) */
+    if (PORTF.IN & PS2_Data_bm)
+        TCA0.SINGLE.CTRLA &= ~TCA_SINGLE_ENABLE_bm;
+    else
+        PORTF.PIN1CTRL = PORT_PULLUPEN_bm;
+}
+
+/*
+ * PS/2 Data line pin change Interrupt Handler (called by the MCC PORTF ISR)
+ */
+static void ps2DataInterrupt(void) 
+{
+    ps2TimerStart();
+}
+#endif
+
+/*
+ * Function to Add a Command response to send, to the responseBuffer
+ */
+static void responseBufferAdd(uint8_t addCode) 
+{
+    uint8_t end = PS2_ResponseBuffer_End;
+
+    /* If buffer is full, drop this (newest) value */
+    if ((uint8_t)(end - PS2_ResponseBuffer_Start) == PS2_ResponseBuffer_Size)
+    {
+        PS2_ResponseDropCount++;
+        return;
+    }
+
+    PS2_ResponseBuffer[end & PS2_ResponseBuffer_Mask] = addCode;
+
+    /* Only now is it added (for the ISR to send) */
+    PS2_ResponseBuffer_End = end + 1;
+#if PS2_QueueStats
+    if ((uint8_t)(end + 1 - PS2_ResponseBuffer_Start) > PS2_ResponseHighWater)
+        PS2_ResponseHighWater = (uint8_t)(end + 1 - PS2_ResponseBuffer_Start);
+#endif
+#if PS2_TimerIdleStop
+    ps2TimerStart();
+#endif
+}
+
+/*
+ * Function to Add a Key Event (KeyPosition, plus PS2_KeyEventBreak_bm if a 
+ * release) to send, to the KeyEventBuffer
+ * N.B. Overflow only ever drops a whole Key Event (the newest), and never 
+ *  part of a ScanCode sequence, so the Host can't see e.g. a bare 74 from 
+ *  E0 F0 74 (a phantom make). Each drop is counted.
+ */
+static void keyEventBufferAdd(uint8_t addEvent) 
+{
+    uint8_t end = PS2_KeyEventBuffer_End;
+
+    /* If buffer is full, drop this (newest) Key Event */
+    if ((uint8_t)(end - PS2_KeyEventBuffer_Start) == PS2_KeyEventBuffer_Size)
+    {
+        PS2_KeyEventDropCount++;
+        return;
+    }
+
+    PS2_KeyEventBuffer[end & PS2_KeyEventBuffer_Mask] = addEvent;
+
+#if PS2_QueueStats
+    if (PS2_LatencyState == PS2_LatencyIdle)
+    {  /* Sample this Key Event's latency (armed before the ISR can send it) */
+        PS2_LatencyEvent = end;
+        PS2_LatencyTicks = 0;
+        PS2_LatencyState = PS2_LatencySampling;
+    }
+#endif
+
+    /* Only now is it added (for the ISR to send) */
+    PS2_KeyEventBuffer_End = end + 1;
+#if PS2_QueueStats
+    if ((uint8_t)(end + 1 - PS2_KeyEventBuffer_Start) > PS2_KeyEventHighWater)
+        PS2_KeyEventHighWater = (uint8_t)(end + 1 - PS2_KeyEventBuffer_Start);
+#endif
+#if PS2_TimerIdleStop
+    ps2TimerStart();
+#endif
+}
+
+/*
+ * Function to get a Key Event's ScanCode sequence (make or break), from the 
+ * key tables. First byte of the sequence is its length.
+ */
+static inline const uint8_t *keyEventSequence(uint8_t event) 
+{
+    uint8_t position = event & PS2_KeyEventPosition_gm;
+
+    if (event & PS2_KeyEventBreak_bm)
+        return PS2_KeyBreak[KeyPositionRow(position)][KeyPositionCol(position)];
+    return PS2_KeyMake[KeyPositionRow(position)][KeyPositionCol(position)];
+}
+
+/*
+ * Function to drive a Keyboard matrix row low, ready for reading its columns.
+ * Time is noted, so that reading can wait for the row to settle.
+ */
+static uint16_t RowDrivenTime;
+
+static void scanRowDrive(uint8_t r) 
+{
+    PORTA.DIRSET = RowCol_bm[r];
+    PORTA.OUTCLR = RowCol_bm[r];
+    RowDrivenTime = TimeBase.CNT;
+}
+
+/*
+ * Function to read the columns of the (driven) Keyboard matrix row, once the
+ * row has settled, then return the row to Input.
+ */
+static uint8_t scanRowRead(uint8_t r) 
+{
+    uint8_t matrix_row;
+
+    /* Wait for any remaining settle time */
+    while ((uint16_t)(TimeBase.CNT - RowDrivenTime) < (RowSettleUs * TimeBase_TicksPerUs))
+        ;
+    /* re-read Joystick to get Button Right & Left (1 is ON) */
+    matrix_row = PORTD.IN;
+    /* Return to Input for this row */
+    PORTA.DIRCLR = RowCol_bm[r];
+
+    return matrix_row;
+}
+
+#if DebounceAdaptive
+/*
+ * Function to Set the learnt de-bounce interval of a key switch
+ * N.B. Also clears its count of settled key changes.
+ */
+static void debounceWindowSet(uint8_t r, uint8_t c, uint8_t window) 
+{
+    KeyswitchWindow[PS2_KeyIndex[r][c]] = window;
+
+    for (uint8_t b = 0; b < DebounceCountBits; b++)
+    {
+        if (window & (1 << b)) KeyswitchWindowBits[r][b] |= RowCol_bm[c];
+        else KeyswitchWindowBits[r][b] &= ~RowCol_bm[c];
+    }
+}
+
+/*
+ * Function to Learn from a key switch that has bounced back while de-bouncing.
+ * Its count is how many scans its chatter looked stable for.
+ */
+static void debounceLearnChatter(uint8_t r, uint8_t c, const uint8_t *count) 
+{
+    uint8_t window = DebounceAdaptiveMargin;
+
+    for (uint8_t b = 0; b < DebounceCountBits; b++)
+        if (count[b] & RowCol_bm[c]) window += (1 << b);
+
+    if (window > DebounceCount) window = DebounceCount;
+    if (window < (KeyswitchWindow[PS2_KeyIndex[r][c]] & KeyswitchWindow_gm))
+        window = KeyswitchWindow[PS2_KeyIndex[r][c]] & KeyswitchWindow_gm;
+
+    debounceWindowSet(r, c, window);
+}
+
+/*
+ * Function to Learn from a key switch change that has been confirmed.
+ * After enough settled changes in a row (without chatter), shorten its interval.
+ */
+static void debounceLearnSettled(uint8_t r, uint8_t c) 
+{
+    uint8_t window = KeyswitchWindow[PS2_KeyIndex[r][c]];
+
+    if ((window & KeyswitchSettled_gm) < ((DebounceAdaptiveSettled - 1) * KeyswitchSettled_1))
+    {
+        KeyswitchWindow[PS2_KeyIndex[r][c]] = window + KeyswitchSettled_1;
+    } else
+    {
+        window &= KeyswitchWindow_gm;
+        if (window > DebounceAdaptiveMin) window--;
+        debounceWindowSet(r, c, window);
+    }
+}
+
+/*
+ * Function to Query the learnt de-bounce interval (in Keyboard Scans) of a 
+ * key switch, for diagnostics.
+ */
+static inline uint8_t debounceWindow(uint8_t r, uint8_t c) 
+{
+    return KeyswitchWindow[PS2_KeyIndex[r][c]] & KeyswitchWindow_gm;
+}
+
+/*
+ * Function to Reset every key switch to the full de-bounce interval (so that 
+ * learning starts over).
+ */
+static void debounceWindowsReset(void) 
+{
+    for (uint8_t r = 0; r < MatrixRows; r++)
+        for (uint8_t c = 0; c < MatrixCols; c++)
+            if (PS2_KeyValid_bm[r] & RowCol_bm[c])
+                debounceWindowSet(r, c, DebounceCount);
+}
+#endif
+
+/*
+ * Function to Process a Keyboard matrix row
+ * De-bounce delay any detected changes, then store Key Events in KeyEventBuffer
+ * 
+ * De-bouncing is done for all 8 columns of a row at once. Each column whose
+ * state differs from its de-bounced state has its count incremented, all other
+ * columns have their count cleared. Once a count reaches DebounceCount the 
+ * new key state is confirmed (i.e. DebounceCount consecutive matching scans).
+ * For DebounceEager, a changed column is confirmed straight away and its count
+ * is instead used to lock it out, until DebounceCount scans have passed.
+ * For DebounceAdaptive, each count is compared with the key's learnt interval.
+ * Rows that haven't changed since the last scan, and have no columns still
+ * de-bouncing, are skipped entirely (which is nearly always the case!).
+ * Columns with no key switch fitted are ignored (PS2_KeyValid_bm).
+ */
+static void processKeyboardRow(uint8_t r, uint8_t matrix_row) 
+{
+    uint8_t delta;      /* columns that changed since the last scan */
+    uint8_t changed;    /* columns that differ from their de-bounced state */
+    uint8_t counting;   /* columns with an incrementing count */
+    uint8_t carry;      /* vertical counter increment carry, per column */
+    uint8_t reached;    /* columns whose count has reached DebounceCount */
+    uint8_t confirmed;  /* columns with a confirmed key state change */
+    uint8_t countBit;
+    uint8_t *count;
+#if DebounceAdaptive
+    uint8_t bounced;    /* columns that have bounced back while de-bouncing */
+#endif
+#if DebounceEager && GhostDetect
+    uint8_t held;       /* columns with a key press held for ghostDetect() */
+#endif
+
+    /* Columns with no key switch are always released (so never de-bounced) */
+    matrix_row |= ~PS2_KeyValid_bm[r];
+
+    /* Skip this row if it is unchanged, and settled */
+    delta = matrix_row ^ KeyswitchLastRow[r];
+#if GhostDetect
+#if DebounceEager
+    if (((delta | KeyswitchInFlight[r] | KeyswitchPressHeld[r]) == 0) && !KeyswitchRescan)
+#else
+    if (((delta | KeyswitchInFlight[r]) == 0) && !KeyswitchRescan)
+#endif
+        return;
+    KeyswitchLastRow[r] = matrix_row;
+
+    /* While ghosting, hold back any key presses (released keys stay released) */
+    if (KeyswitchGhosting)
+        matrix_row |= KeyswitchReleased[r];
+#else
+    if ((delta | KeyswitchInFlight[r]) == 0)
+        return;
+    KeyswitchLastRow[r] = matrix_row;
+#endif
+
+    /* Process all columns in the current row */
+    changed = matrix_row ^ KeyswitchReleased[r];
+    count = KeyswitchDebounce[r];
+
+#if DebounceAdaptive
+    /* Learn from any columns that were de-bouncing, but have bounced back */
+    bounced = KeyswitchInFlight[r] & ~changed;
+    for (uint8_t c = 0; bounced; c++, bounced >>= 1)
+        if (bounced & 0x01) debounceLearnChatter(r, c, count);
+#endif
+
+#if DebounceEager
+    /* Columns that are locked out are counting */
+    counting = KeyswitchInFlight[r];
+#else
+    /* Changed columns are counting */
+    counting = changed;
+#endif
+
+    /* Increment the count of counting columns, clear all other counts */
+    carry = counting;
+    for (uint8_t b = 0; b < DebounceCountBits; b++)
+    {
+        countBit = count[b];
+        count[b] = (countBit ^ carry) & counting;
+        carry &= countBit;
+    }
+
+    /* Check which counts have now reached DebounceCount (and clear them) */
+    reached = counting;
+    for (uint8_t b = 0; b < DebounceCountBits; b++)
+    {
+#if DebounceAdaptive
+        reached &= ~(count[b] ^ KeyswitchWindowBits[r][b]);
+#else
+        if (DebounceCount & (1 << b)) reached &= count[b];
+        else reached &= ~count[b];
+#endif
+    }
+    for (uint8_t b = 0; b < DebounceCountBits; b++)
+        count[b] &= ~reached;
+
+#if DebounceEager
+    /* Any changed columns not locked out are confirmed, and now locked out */
+    KeyswitchInFlight[r] = counting & ~reached;
+    confirmed = changed & ~KeyswitchInFlight[r];
+#if GhostDetect
+    /* Except key presses first read this scan, held until the next scan */
+    held = confirmed & ~matrix_row & ~KeyswitchPressHeld[r];
+    KeyswitchPressHeld[r] = held;
+    confirmed &= ~held;
+#endif
+    KeyswitchInFlight[r] |= confirmed;
+#else
+    /* Any changed columns not yet confirmed are still de-bouncing */
+    confirmed = reached;
+    KeyswitchInFlight[r] = changed & ~confirmed;
+#endif
+
+    if (confirmed)
+    {  /* Key action confirmed! */
+        KeyswitchReleased[r] ^= confirmed;
+
+        for (uint8_t c = 0; confirmed; c++, confirmed >>= 1)
+        {
+#if DebounceAdaptive
+            if (confirmed & 0x01) debounceLearnSettled(r, c);
+#endif
+            /* Send the key's break (released) or make (pressed) event */
+            if ((confirmed & 0x01) && (PS2_KeyValid_bm[r] & RowCol_bm[c]))
+            {
+                if (!keyIsDown(KeyPosition(r, c)))
+                    keyEventBufferAdd(KeyPosition(r, c) | PS2_KeyEventBreak_bm);
+                else
+                    keyEventBufferAdd(KeyPosition(r, c));
+            }
+        }
+    }
+}
+
+#if GhostDetect
+/*
+ * Function to Detect ghost key patterns, from the last read of every row.
+ * A ghost pattern is any row with more than one key pressed, sharing one of
+ * these columns with another row. Found by tracking which columns are pressed
+ * in more than one row, and which columns are in rows with multiple keys.
+ */
+static void ghostDetect(void) 
+{
+    uint8_t pressed;
+    uint8_t once = 0;   /* columns pressed in at least one row */
+    uint8_t twice = 0;  /* columns pressed in more than one row */
+    uint8_t multi = 0;  /* columns of rows with more than one key pressed */
+    bool ghosting;
+
+    for (uint8_t r = 0; r < MatrixRows; r++)
+    {
+        pressed = ~KeyswitchLastRow[r];
+        twice |= once & pressed;
+        once |= pressed;
+        if (pressed & (pressed - 1)) multi |= pressed;
+    }
+    ghosting = ((multi & twice) != 0);
+
+    if (ghosting && !KeyswitchGhosting && (KeyswitchGhostCount != 0xFFFF))
+        KeyswitchGhostCount++;
+    KeyswitchRescan = (KeyswitchGhosting && !ghosting);
+    KeyswitchGhosting = ghosting;
+}
+#endif
+
+#if !(ScanTimerDriven && ScanTimerRowPerPeriod)
+/*
+ * Function to Scan our Keyboard matrix
+ * Row reads are pipelined, the next row is driven as soon as the current row
+ * is read, so that it settles while the current row is processed.
+ * N.B. Row 0 is driven at the end of the previous scan (or by main() at start).
+ */
+static void scanKeyboard(void) 
+{
+    uint8_t matrix_row;
+    
+    for (uint8_t r = 0; r < MatrixRows; r++)
+    {
+        /* For each Row, read the row columns (row is already output low) */
+        matrix_row = scanRowRead(r);
+
+        /* Drive the next row now, so it is settling while we process this one */
+        scanRowDrive((r + 1 < MatrixRows) ? r + 1 : 0);
+
+        processKeyboardRow(r, matrix_row);
+    }
+}
+#endif
+
+#if ScanTimerDriven
+/*
+ * ScanTimerTicks counts ScanTimer periods (and is only written by the ISR).
+ */
+static volatile uint8_t ScanTimerTicks = 0;
+
+/*
+ * Scan Timer Interrupt - INTERRUPT SERVICE ROUTINE!
+ * Interrupt is called every ScanTimerPeriodUs, to request a Keyboard scan.
+ */
+ISR(TCB0_INT_vect)
+{
+    ScanTimer.INTFLAGS = TCB_CAPT_bm;
+    ScanTimerTicks++;
+}
+
+#if ScanTimerRowPerPeriod
+/*
+ * Function to Scan the next row of our Keyboard matrix
+ * N.B. The row was driven during the previous ScanTimer period, so has 
+ *  already settled.
+ * Returns true once the last row of the matrix has been scanned.
+ */
+static bool scanKeyboardRow(void) 
+{
+    static uint8_t r = 0;
+    uint8_t matrix_row;
+    uint8_t nextRow;
+
+    matrix_row = scanRowRead(r);
+
+    /* Drive the next row now, ready for the next ScanTimer period */
+    nextRow = (r + 1 < MatrixRows) ? r + 1 : 0;
+    scanRowDrive(nextRow);
+
+    processKeyboardRow(r, matrix_row);
+    r = nextRow;
+
+    return (r == 0);
+}
+#endif
+#endif
 
+#if ScanStats
 /*
- * DataToClockDelay defines delay in microseconds between Data transition
- * (or sampling), and clock edge transition.
+ * Scan statistics, with all periods in TimeBase ticks (TimeBase_TicksPerUs 
+ * per microsecond).
+ * ScanStatsJitter[b] counts scans with jitter under 2^b us (for b = 0 - 6), 
+ *  or with jitter of 64us and over (b = 7). 
+ * A ScanStatsLastPeriod of 0 means there's no previous period (for jitter).
+ * N.B. Scan periods over 6553us (i.e. TimeBase wraps) aren't measured right!
  */
-#define DataToClockDelay 10
+#define ScanStatsJitterBuckets 8
+static bool ScanStatsRunning = false;
+static uint16_t ScanStatsLastTime;
+static uint16_t ScanStatsLastPeriod;
+static uint16_t ScanStatsMin;
+static uint16_t ScanStatsMax;
+static uint32_t ScanStatsSum;
+static uint16_t ScanStatsCount;
+static uint16_t ScanStatsJitter[ScanStatsJitterBuckets];
 
 /*
- * Scan Code to be sent prior to key Scan Code on key release.
+ * Function to Restart scan period measuring (e.g. after Keyboard idle)
  */
-#define ReleaseScanCode 0xF0
+static void scanStatsRestart(void) 
+{
+    ScanStatsRunning = false;
+    ScanStatsLastPeriod = 0;
+}
 
 /*
- * Scan Code to be sent prior to Extended key Scan Code.
+ * Function to Clear the scan statistics
  */
-#define ExtendedScanCode 0xE0
+static void scanStatsClear(void) 
+{
+    ScanStatsMin = 0xFFFF;
+    ScanStatsMax = 0;
+    ScanStatsSum = 0;
+    ScanStatsCount = 0;
+    for (uint8_t b = 0; b < ScanStatsJitterBuckets; b++)
+        ScanStatsJitter[b] = 0;
+    scanStatsRestart();
+}
 
 /*
- * PS/2 Scan Codes based on keyboard key matrix Row / Column.
- * Rows are PORTA, Columns are PORTD 
+ * Function to Update the scan statistics, at the end of each full scan
  */
-static const uint8_t PS2_KeyScanCode[MatrixRows][MatrixCols] 
-                        = {{0x16,0x1E,0x26,0x25,0x2E,0x36,0x00,0x00},
-                           {0x00,0x15,0x1D,0x24,0x2D,0x2C,0x14,0x00},
-                           {0x6B,0x1C,0x1B,0x23,0x2B,0x34,0x00,0x00},
-                           {0x00,0x1A,0x22,0x21,0x2A,0x32,0x00,0x59},
-                           {0x3D,0x3E,0x46,0x45,0x52,0x4E,0x00,0x00},
-                           {0x35,0x3C,0x43,0x44,0x4D,0x5A,0x00,0x00},
-                           {0x33,0x3B,0x42,0x4B,0x4C,0x74,0x00,0x00},
-                           {0x31,0x3A,0x41,0x49,0x4A,0x29,0x00,0x00}};
+static void scanStatsUpdate(void) 
+{
+    uint16_t now = TimeBase.CNT;
+    uint16_t period = now - ScanStatsLastTime;
+    uint16_t jitter;
+    uint8_t b;
 
-/* 
- * KeyswitchDebounce = the decrementing de-bounce count 
- * KeyswitchReleased = true if key switch is released (open), or false if closed.
- */ 
-static uint8_t KeyswitchDebounce[MatrixRows][MatrixCols];
-static bool KeyswitchReleased[MatrixRows][MatrixCols];
+    ScanStatsLastTime = now;
+    
+    /* The first scan just starts measuring */
+    if (!ScanStatsRunning)
+    {
+        ScanStatsRunning = true;
+        return;
+    }
+
+    if (period < ScanStatsMin)
+        ScanStatsMin = period;
+    if (period > ScanStatsMax)
+        ScanStatsMax = period;
+
+    /* Before the count overflows, halve both sum and count (keeping the mean) */
+    if (ScanStatsCount == 0xFFFF)
+    {
+        ScanStatsSum >>= 1;
+        ScanStatsCount >>= 1;
+    }
+    ScanStatsSum += period;
+    ScanStatsCount++;
+
+    if (ScanStatsLastPeriod)
+    {
+        jitter = (period > ScanStatsLastPeriod) ? (period - ScanStatsLastPeriod)
+                                                : (ScanStatsLastPeriod - period);
+
+        /* Histogram bucket is the bit length of the jitter in us (max. 7) */
+        for (b = 0, jitter /= TimeBase_TicksPerUs; jitter && (b < (ScanStatsJitterBuckets - 1)); jitter >>= 1)
+            b++;
+        if (ScanStatsJitter[b] != 0xFFFF)
+            ScanStatsJitter[b]++;
+    }
+    ScanStatsLastPeriod = period;
+}
+#endif
 
 /*
- * PORT bit mask for each row or column
+ * Diagnostics command (0xE1) is vendor specific, and is followed by a page 
+ * number Data byte. Both are acknowledged (0xFA), then the page is sent as a
+ * length byte, followed by that many bytes (16 bit values are low byte first).
+ * Setting bit 7 of the page number also clears that page, once sent.
+ *  Page 0: Scan statistics (if ScanStats), Count, Min, Max, Mean scan period 
+ *      (TimeBase ticks), then the ScanStatsJitterBuckets jitter counts.
+ *  Page 1: PS/2 clock, Clock rate (100Hz units), auto-probe (1 = probing),
+ *      and Resend (0xFE) requests count.
+ *  Page 2: PS/2 buffers, overflow (dropped) counts of Key Events, Responses,
+ *      then Commands (8 bit). Then (if PS2_QueueStats) Key Events current
+ *      depth and high watermark, Responses high watermark, Commands current
+ *      depth (including this page number) and high watermark (all 8 bit), 
+ *      then Key Event latency sample Count, Min, Max (us, sampled one Key
+ *      Event at a time, to the nearest Timer interrupt).
+ *  Page 3: Learnt de-bounce intervals (if DebounceAdaptive), in Keyboard 
+ *      Scans, one byte per key switch in key number order (PS2_KeyIndex).
+ *      Clearing this page starts learning over (from DebounceCount).
+ *  Page 4: Ghost key patterns (if GhostDetect), count of patterns detected.
+ * Unknown (or disabled) pages are sent with length 0.
  */
-static const uint8_t RowCol_bm[MatrixRows] 
-                        = {PIN0_bm,PIN1_bm,PIN2_bm,PIN3_bm,PIN4_bm,PIN5_bm,PIN6_bm,PIN7_bm};
+#define PS2_DiagnosticsCommand 0xE1
+#define DiagnosticsPageScanStats 0
+#define DiagnosticsPagePS2Clock 1
+#define DiagnosticsPagePS2Buffers 2
+#define DiagnosticsPageDebounce 3
+#define DiagnosticsPageGhosts 4
+#define DiagnosticsPageClear_bm 0x80
 
 /*
- * PS/2 Keyboard ScanCode Transmission Buffer
- * Rotating buffer containing the ScanCodes to send.
+ * Function to Send a 16 bit diagnostics value
  */
-#define PS2_ScanCodeBuffer_Size 128
-static volatile uint8_t PS2_ScanCodeBuffer[PS2_ScanCodeBuffer_Size];
-static volatile uint8_t PS2_ScanCodeBuffer_Start = 0;
-static volatile uint8_t PS2_ScanCodeBuffer_End   = 0;
+static void diagnosticsAdd16(uint16_t value) 
+{
+    responseBufferAdd(value & 0xFF);
+    responseBufferAdd(value >> 8);
+}
 
 /*
- * PS/2 Host Command Receive Buffer
- * Rotating buffer containing the Host Commands / Data received.
+ * Function to Send a diagnostics page
  */
-#define PS2_CommandBuffer_Size 128
-static volatile uint8_t PS2_CommandBuffer[PS2_CommandBuffer_Size];
-static volatile uint8_t PS2_CommandBuffer_Start = 0;
-static volatile uint8_t PS2_CommandBuffer_End   = 0;
+static void diagnosticsSend(uint8_t page) 
+{
+    switch (page & ~DiagnosticsPageClear_bm)
+    {
+#if ScanStats
+        case DiagnosticsPageScanStats:
+            responseBufferAdd(2 * (4 + ScanStatsJitterBuckets));
+            diagnosticsAdd16(ScanStatsCount);
+            diagnosticsAdd16(ScanStatsCount ? ScanStatsMin : 0);
+            diagnosticsAdd16(ScanStatsMax);
+            diagnosticsAdd16(ScanStatsCount ? (ScanStatsSum / ScanStatsCount) : 0);
+            for (uint8_t b = 0; b < ScanStatsJitterBuckets; b++)
+                diagnosticsAdd16(ScanStatsJitter[b]);
+
+            if (page & DiagnosticsPageClear_bm)
+                scanStatsClear();
+            break;
+#endif
+
+        case DiagnosticsPagePS2Clock:
+            responseBufferAdd(4);
+            responseBufferAdd(PS2_ClockRate);
+            responseBufferAdd(PS2_ClockProbe);
+            diagnosticsAdd16(PS2_ResendCount);
+
+            if (page & DiagnosticsPageClear_bm)
+                PS2_ResendCount = 0;
+            break;
+
+        case DiagnosticsPagePS2Buffers:
+#if PS2_QueueStats
+            responseBufferAdd(5 + 5 + 6);
+#else
+            responseBufferAdd(5);
+#endif
+            diagnosticsAdd16(PS2_KeyEventDropCount);
+            diagnosticsAdd16(PS2_ResponseDropCount);
+            responseBufferAdd(PS2_CommandDropCount);
+#if PS2_QueueStats
+            responseBufferAdd(PS2_KeyEventBuffer_End - PS2_KeyEventBuffer_Start);
+            responseBufferAdd(PS2_KeyEventHighWater);
+            responseBufferAdd(PS2_ResponseHighWater);
+            responseBufferAdd(PS2_CommandBuffer_End - PS2_CommandBuffer_Start);
+            responseBufferAdd(PS2_CommandHighWater);
+            diagnosticsAdd16(PS2_LatencyCount);
+            diagnosticsAdd16(PS2_LatencyCount ? PS2_LatencyMin : 0);
+            diagnosticsAdd16(PS2_LatencyMax);
+#endif
+
+            if (page & DiagnosticsPageClear_bm)
+            {
+                PS2_KeyEventDropCount = 0;
+                PS2_ResponseDropCount = 0;
+                PS2_CommandDropCount = 0;
+#if PS2_QueueStats
+                PS2_KeyEventHighWater = 0;
+                PS2_ResponseHighWater = 0;
+                PS2_CommandHighWater = 0;
+                PS2_LatencyCount = 0;
+                PS2_LatencyMin = 0xFFFF;
+                PS2_LatencyMax = 0;
+#endif
+            }
+            break;
+
+#if DebounceAdaptive
+        case DiagnosticsPageDebounce:
+            responseBufferAdd(PS2_KeyCount);
+            for (uint8_t r = 0; r < MatrixRows; r++)
+                for (uint8_t c = 0; c < MatrixCols; c++)
+                    if (PS2_KeyValid_bm[r] & RowCol_bm[c])
+                        responseBufferAdd(debounceWindow(r, c));
+
+            if (page & DiagnosticsPageClear_bm)
+                debounceWindowsReset();
+            break;
+#endif
+
+#if GhostDetect
+        case DiagnosticsPageGhosts:
+            responseBufferAdd(2);
+            diagnosticsAdd16(KeyswitchGhostCount);
+
+            if (page & DiagnosticsPageClear_bm)
+                KeyswitchGhostCount = 0;
+            break;
+#endif
+
+        default:
+            responseBufferAdd(0);
+    }
+}
 
 /*
- * PS/2 PORT PIN Bit Mask (bm) Definitions (PORTF is currently used)
+ * Clock Rate command (0xE2) is vendor specific, and is followed by a clock 
+ * rate Data byte, either PS2_ClockRateMin - PS2_ClockRateMax (in 100Hz units), 
+ * or 0 to auto-probe (step up) the clock rate. Both are acknowledged (0xFA), 
+ * then the new clock rate is used from the next byte sent.
  */
-static const uint8_t PS2_Clock_bm  = PIN0_bm;
-static const uint8_t PS2_Data_bm = PIN1_bm;
+#define PS2_ClockRateCommand 0xE2
 
 /*
- * Function to Add a code to send, to the scanCodeBuffer
+ * Function to Set the PS/2 clock rate (100Hz units), within the legal range
  */
-static void scanCodeBufferAdd(uint8_t addCode) 
+static void ps2ClockRateSet(uint8_t rate) 
 {
+    if (rate < PS2_ClockRateMin)
+        rate = PS2_ClockRateMin;
+    else if (rate > PS2_ClockRateMax)
+        rate = PS2_ClockRateMax;
+
+    PS2_ClockRate = rate;
     ATOMIC_BLOCK(ATOMIC_FORCEON) 
     {
-        PS2_ScanCodeBuffer[PS2_ScanCodeBuffer_End] = addCode;
-
-        if (++PS2_ScanCodeBuffer_End == PS2_ScanCodeBuffer_Size)
-            PS2_ScanCodeBuffer_End = 0;
+        PS2_ClockHalfPeriod = PS2_ClockHalfPeriodTicks(rate);
+    }
+}
 
-        /* If buffer is now full, drop oldest value */
-        if ((PS2_ScanCodeBuffer_End == PS2_ScanCodeBuffer_Start)
-            && (++PS2_ScanCodeBuffer_Start == PS2_ScanCodeBuffer_Size))
-                PS2_ScanCodeBuffer_Start = 0;
-    }    
+/*
+ * Function to Process the Clock Rate command Data byte
+ */
+static void ps2ClockRateCommand(uint8_t rate) 
+{
+    if (rate == 0)
+    {  /* Auto-probe, stepping up from the current clock rate */
+        PS2_SentCount = 0;
+        PS2_ClockProbe = true;
+    } else
+    {
+        PS2_ClockProbe = false;
+        ps2ClockRateSet(rate);
+    }
 }
 
 /*
- * Function to Scan our Keyboard matrix
- * De-bounce delay any detected changes, then store Scan Codes in ScanCodeBuffer
+ * Function to Auto-probe the PS/2 clock rate, stepping it up once enough 
+ * bytes have been sent (without a Resend request).
  */
-static void scanKeyboard(void) 
+static void ps2ClockProbeTask(void) 
 {
-    uint8_t matrix_row;
-    bool keySwitchStatus;
-    
-    for (uint8_t r = 0; r < MatrixRows; r++)
+    if (PS2_ClockProbe && (PS2_SentCount >= PS2_ClockProbeBytes))
     {
-        /* For each Row, read the row columns by row output low */
-        PORTA.DIRSET = RowCol_bm[r];
-        PORTA.OUTCLR = RowCol_bm[r];
-        _delay_us(10);
-        /* re-read Joystick to get Button Right & Left (1 is ON) */
-        matrix_row = PORTD.IN;
-        /* Return to Input for this row */
-        PORTA.DIRCLR = RowCol_bm[r];
-        
-        for (uint8_t c = 0; c < MatrixCols; c++)
-        {    
-            /* Process each column in the current row */
-            if (KeyswitchDebounce[r][c] > 1)
-            {  /* We are de-bouncing, so just decrement the de-bounce count */   
-                KeyswitchDebounce[r][c]--;
-            } else
-            {  /* If de-bounce count is down to 1 */  
-                keySwitchStatus = (matrix_row & RowCol_bm[c]);
-                
-                if (KeyswitchDebounce[r][c] == 1)
-                {    
-                    /* Check switch is still in the same state (and has a Scan Code!) */
-                    if ((keySwitchStatus == KeyswitchReleased[r][c])
-                        && (PS2_KeyScanCode[r][c] != 0x00))
-                    {  /* Same state after de-bouncing, key action confirmed! */
-                        if ((PS2_KeyScanCode[r][c] == 0x6B) || (PS2_KeyScanCode[r][c] == 0x74))
-                        {
-                            /* It's an extended Scan Code */
-                            scanCodeBufferAdd(ExtendedScanCode);
-                        }    
-                        if (keySwitchStatus)
-                        {
-                            /* Key was released so first send Release Scan Code */
-                            scanCodeBufferAdd(ReleaseScanCode);
-                        }
-                        /* Send Key Scan Code */
-                        scanCodeBufferAdd(PS2_KeyScanCode[r][c]);
-                    }
-                    KeyswitchDebounce[r][c] = 0;
-                } else
-                { /* If no de-bounce count check if key state has changed. */
-                    if (keySwitchStatus != KeyswitchReleased[r][c])
-                    {  /* key state has changed, save key state and start de-bounce count */  
-                      KeyswitchReleased[r][c] = keySwitchStatus;
-                      KeyswitchDebounce[r][c] = DebounceCount;
-                    }
-                }    
-            }
-        }
+        PS2_SentCount = 0;
+        ps2ClockRateSet(PS2_ClockRate + PS2_ClockProbeStep);
+
+        /* Once at the maximum clock rate, there's nothing more to probe */
+        if (PS2_ClockRate == PS2_ClockRateMax)
+            PS2_ClockProbe = false;
+    }
+}
+
+#if PS2_QueueStats
+/*
+ * Function to collect a (done) Key Event latency sample, in us
+ */
+static void ps2LatencyTask(void) 
+{
+    uint32_t us;
+    uint16_t latency;
+
+    if (PS2_LatencyState == PS2_LatencyDone)
+    {  /* Interrupts are half PS/2 clock cycles (5000 / PS2_ClockRate us) */
+        us = ((uint32_t)PS2_LatencyTicks * 5000UL) / PS2_ClockRate;
+        latency = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+
+        if (PS2_LatencyCount != 0xFFFF)
+            PS2_LatencyCount++;
+        if (latency < PS2_LatencyMin)
+            PS2_LatencyMin = latency;
+        if (latency > PS2_LatencyMax)
+            PS2_LatencyMax = latency;
+
+        /* Ready to sample the next Key Event queued */
+        PS2_LatencyState = PS2_LatencyIdle;
     }
 }
+#endif
+
+/*
+ * Function to Remove the processed command from the CommandBuffer
+ * N.B. Only once processed, as Key Events wait until then (so that the Host 
+ *  gets the Command's response first).
+ */
+static void commandBufferRemove(void) 
+{
+    PS2_CommandBuffer_Start++;
+#if PS2_TimerIdleStop
+    /* Key Events may have waited (with the Timer stopped) for this */
+    ps2TimerStart();
+#endif
+}
 
 /*
  * Function to Process a received Command / Data byte
  */
 static void processCommand(void) 
 {
+    static uint8_t lastCommand = 0;
     uint8_t commandCode;
 
+    ps2ClockProbeTask();
+#if PS2_QueueStats
+    ps2LatencyTask();
+#endif
+
     /* See if there is a command (or data) in the CommandBuffer */ 
     if (PS2_CommandBuffer_Start != PS2_CommandBuffer_End)
     {  /* There is a command received! */
-        commandCode = PS2_CommandBuffer[PS2_CommandBuffer_Start];
+        commandCode = PS2_CommandBuffer[PS2_CommandBuffer_Start & PS2_CommandBuffer_Mask];
+
+        /* Is this the Data byte, following one of our (vendor specific) commands? */
+        /* N.B. Host commands (0xED - 0xFF) still take precedence */
+        if (((lastCommand == PS2_DiagnosticsCommand) || (lastCommand == PS2_ClockRateCommand))
+            && (commandCode < 0xED))
+        {
+            /* First send Acknowledge to Host 0xFA */
+            responseBufferAdd(0xFA);
+
+            if (lastCommand == PS2_DiagnosticsCommand)
+                diagnosticsSend(commandCode);
+            else
+                ps2ClockRateCommand(commandCode);
 
-        /* Remove the retrieved command from the buffer! */
-        if (++PS2_CommandBuffer_Start == PS2_CommandBuffer_Size)
-            PS2_CommandBuffer_Start = 0;
+            lastCommand = 0;
+            commandBufferRemove();
+            return;
+        }
+        lastCommand = commandCode;
 
         /* Process the command! */
         switch (commandCode)
         {
             /* Send appropriate responses to the relevant commands. */
            case 0xFF: /* Reset and self-test */
+                /* Back to the default PS/2 clock rate (no auto-probe) */
+                PS2_ClockProbe = false;
+                ps2ClockRateSet(PS2_ClockRateDefault);
+
+                /* Discard any Key Events not yet sent (by the ISR) */
+                PS2_KeyEventBufferFlush = true;
+
                 /* First send Acknowledge to Host 0xFA */
-                scanCodeBufferAdd(0xFA);
+                responseBufferAdd(0xFA);
 
                 /* Send Self-test is successfully passed to Host 0xAA */
-                scanCodeBufferAdd(0xAA);
+                responseBufferAdd(0xAA);
                 break;
 
             case 0xF2: /* Identify (Request Device ID) */
                 /* First send Acknowledge to Host 0xFA */
-                scanCodeBufferAdd(0xFA);
+                responseBufferAdd(0xFA);
 
                 /* Then send Device ID for Keyboards to Host 0xAB83 */
                     /* Send 0xAB */
-                scanCodeBufferAdd(0xAB);
+                responseBufferAdd(0xAB);
                     /* Send 0x83 */
-                scanCodeBufferAdd(0x83);
+                responseBufferAdd(0x83);
+                break;
+
+            case 0xEE: /* Echo */
+                /* Send Echo back to Host 0xEE (no Acknowledge) */
+                responseBufferAdd(0xEE);
+                break;
+
+            case 0xFE: /* Resend */
+                /* Send the last byte sent again (no Acknowledge) */
+                responseBufferAdd(PS2_LastSent);
+                PS2_ResendCount++;
+
+                /* Auto-probe has found the clock rate is too fast */
+                if (PS2_ClockProbe)
+                {
+                    PS2_ClockProbe = false;
+                    ps2ClockRateSet(PS2_ClockRate - PS2_ClockProbeStep);
+                }
+                break;
+
+            case PS2_DiagnosticsCommand: /* Diagnostics (vendor specific) */
+                /* Send Acknowledge, then wait for the page number Data byte */
+                responseBufferAdd(0xFA);
+                break;
+
+            case PS2_ClockRateCommand: /* Clock Rate (vendor specific) */
+                /* Send Acknowledge, then wait for the clock rate Data byte */
+                responseBufferAdd(0xFA);
                 break;
 
             /* Just Acknowledge any other valid command or data byte received! */
             default:  
                 /* Send Acknowledge only to Host 0xFA */
-                scanCodeBufferAdd(0xFA);
+                responseBufferAdd(0xFA);
                 
             /* NOTE: We are not specifically dealing with commands like
              *  "Set LEDs" (0xED) and the following Data byte(s), as we have
              *  no LEDs to set!
              * Therefore, we are just acknowledging these types of commands
              *  (and data bytes).  
-             * In the future, we could handle these by retaining a "last command"
-             * variable, to enable appropriately handling of following Data bytes.
+             * In the future, we could handle these using the "last command"
+             * variable (as for Diagnostics), to appropriately handle following
+             * Data bytes.
              */ 
         }
+
+        commandBufferRemove();
+    }
+}
+
+/*
+ * Function to Scan our Keyboard, when due (every time, unless ScanTimerDriven)
+ * Returns true once a full Keyboard matrix scan has been done.
+ */
+static bool scanKeyboardTask(void) 
+{
+    bool scanned = true;
+#if ScanTimerDriven
+    static uint8_t scanTicks = 0;
+
+    if (scanTicks == ScanTimerTicks)
+        return false;
+
+    /* ScanTimer period has elapsed, so time to scan! */
+    /* N.B. If we've fallen behind, any missed periods are skipped */
+    scanTicks = ScanTimerTicks;
+#endif
+#if ScanTimerDriven && ScanTimerRowPerPeriod
+    scanned = scanKeyboardRow();
+#else
+    scanKeyboard();
+#endif
+#if ScanStats
+    if (scanned)
+        scanStatsUpdate();
+#endif
+#if GhostDetect
+    /* Once per full scan, check for ghost key patterns */
+    if (scanned)
+        ghostDetect();
+#endif
+    return scanned;
+}
+
+#if KeyboardIdleSleep
+/*
+ * KeyboardWake is set by a column pin change interrupt, while Keyboard idle.
+ */
+static volatile bool KeyboardWake = false;
+
+/*
+ * Column pin change Interrupt Handler (called by the MCC PORTD ISR)
+ */
+static void keyboardWakeInterrupt(void) 
+{
+    KeyboardWake = true;
+}
+
+/*
+ * Function to check if our Keyboard matrix is settled with no keys pressed
+ * (i.e. all key switches are released, and none are de-bouncing).
+ * N.B. The rows as last read (KeyswitchLastRow) are checked too, as key 
+ *  presses held back while ghosting are neither down nor de-bouncing. 
+ *  Otherwise we'd idle after every scan, and be woken straight away.
+ */
+static bool keyboardSettled(void) 
+{
+    uint8_t inFlight = 0;
+    uint8_t released = 0xFF;
+
+    for (uint8_t r = 0; r < MatrixRows; r++)
+    {
+        inFlight |= KeyswitchInFlight[r];
+        released &= KeyswitchLastRow[r];
+    }
+
+    return ((inFlight == 0) && (released == 0xFF) && (keyFirstDown() == KeyNone));
+}
+
+/*
+ * Function to Idle our Keyboard until a key is pressed
+ * All rows are driven low, and column pin change interrupts are enabled, then 
+ * we sleep between processing any received Commands, until woken by a column.
+ */
+static void keyboardIdle(void) 
+{
+#if ScanTimerDriven
+    /* No scanning while idle, so stop the ScanTimer interrupts */
+    ScanTimer.CTRLA &= ~TCB_ENABLE_bm;
+#endif
+
+    /* Drive all rows low (row 0 is already driven, ready for the next scan) */
+    PORTA.DIRSET = 0xFF;
+    PORTA.OUTCLR = 0xFF;
+
+    /* Enable column falling edge interrupts (keeping the Pull-ups) */
+    KeyboardWake = false;
+    PORTD.PINCONFIG = PORT_PULLUPEN_bm | PORT_ISC_FALLING_gc;
+    PORTD.PINCTRLUPD = 0xFF;
+
+    /* Once settled, check no column is already low (as there'd be no edge!) */
+    _delay_us(RowSettleUs);
+    if (PORTD.IN != 0xFF)
+        KeyboardWake = true;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (!KeyboardWake)
+    {
+        processCommand();
+
+        /* Sleep, unless woken or a Command arrived since we last checked */
+        cli();
+        if ((!KeyboardWake) && (PS2_CommandBuffer_Start == PS2_CommandBuffer_End))
+        {
+            sleep_enable();
+            /* N.B. sei() always executes the next instruction (sleep) first */
+            sei();
+            sleep_cpu();
+            sleep_disable();
+        }
+        sei();
+    }
+
+    /* Disable column interrupts, and return all rows to Input */
+    PORTD.PINCONFIG = PORT_PULLUPEN_bm;
+    PORTD.PINCTRLUPD = 0xFF;
+    PORTA.DIRCLR = 0xFF;
+
+    /* Drive the first Keyboard matrix row, ready to resume scanning */
+    scanRowDrive(0);
+
+#if ScanStats
+    /* Time spent idle is not a scan period */
+    scanStatsRestart();
+#endif
+#if ScanTimerDriven
+    ScanTimer.CTRLA |= TCB_ENABLE_bm;
+#endif
+}
+#endif
+
+/*
+ * PS/2 clock edge scheduled by the Timer (overflow) Interrupt, as the PORTF 
+ * DIRSET / DIRCLR bits to write, when Timer compare 0 (CMP0) is reached.
+ */
+static volatile uint8_t PS2_EdgeDirSet = 0;
+static volatile uint8_t PS2_EdgeDirClr = 0;
+
+/*
+ * Function to Schedule a PS/2 clock edge, at Timer compare 0 after the Timer 
+ * (overflow) Interrupt. Only called from the Timer (overflow) Interrupt.
+ * N.B. Always inlined (as for ps2TimerStop()), even though it's called twice.
+ */
+static inline __attribute__((always_inline)) void ps2ClockEdge(uint8_t dirSet, uint8_t dirClr) 
+{
+    PS2_EdgeDirSet = dirSet;
+    PS2_EdgeDirClr = dirClr;
+
+    /* Enable the compare interrupt, clearing the flag from the last period */
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_CMP0_bm;
+    if (TCA0.SINGLE.CNT < TCA0.SINGLE.CMP0)
+        TCA0.SINGLE.INTCTRL |= TCA_SINGLE_CMP0_bm;
+    else
+    {  /* We're late (interrupt latency), so issue the clock edge now! */
+        PORTF.DIRSET = dirSet;
+        PORTF.DIRCLR = dirClr;
     }
 }
 
+/*
+ * Timer Compare Interrupt - INTERRUPT SERVICE ROUTINE!
+ * Interrupt is enabled only when a PS/2 clock edge is scheduled, and issues it.
+ */
+ISR(TCA0_CMP0_vect)
+{
+    PORTF.DIRSET = PS2_EdgeDirSet;
+    PORTF.DIRCLR = PS2_EdgeDirClr;
+
+    TCA0.SINGLE.INTCTRL &= ~TCA_SINGLE_CMP0_bm;
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_CMP0_bm;
+}
+
+/*
+ * Function to Return the parity of a byte (1 if it has an odd number of 1 bits)
+ * N.B. The byte's two nibbles are folded into one (same parity), which is 
+ *  looked up in a table. A variable shift would be a loop on the AVR (it 
+ *  only shifts by 1 bit per instruction), inside the Timer Interrupt.
+ */
+static inline uint8_t ps2Parity(uint8_t data) 
+{
+    static const uint8_t nibbleParity[16] = {0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0};
+
+    return nibbleParity[(data ^ (data >> 4)) & 0x0F];
+}
+
+/*
+ * Function to Build the 11 bit PS/2 frame for sending a byte, in send order 
+ * from bit 0: start bit (0), 8 data bits (LSB first), odd parity bit, and 
+ * stop bit (1).
+ */
+static inline uint16_t ps2Frame(uint8_t data) 
+{
+    return ((uint16_t)data << 1) | ((uint16_t)(ps2Parity(data) ^ 0x01) << 9) | (1 << 10);
+}
+
+/*
+ * Function to Output the next PS/2 frame bit (bit 0) on the Data line
+ */
+static inline void ps2FrameBit(uint16_t frame) 
+{
+    if (frame & 0x01)
+        PORTF.DIRCLR = PS2_Data_bm;
+    else
+        PORTF.DIRSET = PS2_Data_bm;
+}
+
+/*
+ * PS/2 protocol states.
+ * Bus states (checked every Timer Interrupt, while our PS/2 Clock is high):
+ *  PS2_Idle - waiting for the bus to be idle, or a Host Request To Send.
+ *  PS2_Inhibit - Host is Inhibiting the bus (PS/2 Clock line low).
+ *  PS2_Ready - bus is idle, so send a byte (if there is one).
+ *  PS2_RequestToSend - Host Request To Send (PS/2 Data line low), so receive.
+ * Clocking states (a PS/2 clock cycle is 2 Timer Interrupts, clock high then
+ * low), as described by PS2_States below:
+ *  PS2_Transmit - send start bit, 8 data bits and parity bit.
+ *  PS2_Stop - send stop bit, then the byte sent is removed from the buffer.
+ *  PS2_Receive - receive start bit, 8 data bits and parity bit.
+ *  PS2_Ack - send Acknowledge bit.
+ */
+enum 
+{
+    PS2_Idle,
+    PS2_Inhibit,
+    PS2_Ready,
+    PS2_RequestToSend,
+    PS2_Transmit,
+    PS2_Stop,
+    PS2_Receive,
+    PS2_Ack
+};
+
+/*
+ * PS2_States is the clocking state transition table, for each clocking state:
+ *  Bits = the clock cycles (bits) in the state.
+ *  Next = the state to go to, after the last clock cycle.
+ *  Flags = what to do in the state, as below.
+ */
+#define PS2_Inhibitable 0x01 /* Host pulling the PS/2 Clock line low aborts */
+#define PS2_SendBit     0x02 /* Output a frame bit each clock cycle */
+#define PS2_ReceiveBit  0x04 /* Sample a frame bit each clock cycle */
+#define PS2_ExitRemove  0x08 /* After the last clock cycle, remove the byte sent */
+#define PS2_ExitCommand 0x10 /* After the last clock cycle, store the command */
+#define PS2_ExitRelease 0x20 /* On the last clock rising edge, release Data line */
+
+typedef struct 
+{
+    uint8_t Bits;
+    uint8_t Next;
+    uint8_t Flags;
+} PS2_State_t;
+
+static const PS2_State_t PS2_States[] = 
+{
+    [PS2_Transmit] = {10, PS2_Stop, PS2_Inhibitable | PS2_SendBit},
+    /* N.B. Some Host's pull clock low straight after the parity bit, so the 
+     *  stop / ack bit is sent anyway (not Inhibitable) */
+    [PS2_Stop]     = {1,  PS2_Idle, PS2_SendBit | PS2_ExitRemove | PS2_ExitRelease},
+    [PS2_Receive]  = {10, PS2_Ack,  PS2_Inhibitable | PS2_ReceiveBit | PS2_ExitCommand},
+    [PS2_Ack]      = {1,  PS2_Idle, PS2_SendBit | PS2_ExitRelease}
+};
+
 /*
  * Timer Interrupt - INTERRUPT SERVICE ROUTINE!
  * Interrupt is called every half PS/2 clock cycle, for creating PS/2 communications
+ * N.B. Clock edges are not issued here, but scheduled with ps2ClockEdge(), so
+ *  this interrupt never busy-waits.
+ * N.B. There are no loops (or switch jump tables), so every path through this 
+ *  Interrupt has a fixed cycle count. That includes variable shifts, as the 
+ *  AVR shifts one bit per instruction (so they are loops, see ps2Parity()).
+ *  tools/isrwcet.py reports the worst case from the built image, and fails
+ *  the build if it finds a loop, or is over budget.
  */
+#if PS2_DirectVector
+static inline __attribute__((always_inline)) void TCA0_OverflowInterrupt(void) 
+#else
 void TCA0_OverflowInterrupt(void) 
+#endif
 {
+    static uint8_t state = PS2_Idle;/* PS/2 protocol state */
+    static uint8_t bits = 0;        /* clock cycles (bits) left in a clocking state */
     static uint8_t clock = 1;       /* send clock high = 1, send clock low = 0 */
-  	static uint8_t clockCount = 0;  /* count of clock cycles */
-    static uint8_t parityCount = 0; /* parity bit calculation */
-    static uint8_t scanCode = 0;    /* scanCode being sent, command being received */
-    static uint8_t sendMode = 1;    /* Keyboard send = 1, Keyboard receive = 0 */
-    static uint8_t clockInput = 0;  /* sampled PS/2 Clock line high = 1, low = 0 */
-    static uint8_t dataInput = 0;   /* sampled PS/2 Data line high = 1, low = 0 */
+    static uint16_t frame = 0;      /* frame being sent (bit 0 is next) or received */
+    static uint8_t sending = 0;     /* byte being sent */
+    static bool sendingResponse = false; /* byte being sent is a Command response */
+    static uint8_t eventSent = 0;   /* bytes of the Key Event's sequence sent */
+    static uint8_t eventLength = 0; /* length of the Key Event's sequence */
+    uint8_t input;                  /* sampled PS/2 Clock & Data lines */
+    uint8_t flags;
+    uint8_t release;
+    uint8_t command;
+    uint16_t period;
+
+#if PS2_QueueStats
+    /* Key Event latency sample, counted in interrupts */
+    if ((PS2_LatencyState == PS2_LatencySampling) && (PS2_LatencyTicks != 0xFFFF))
+        PS2_LatencyTicks++;
+#endif
 
     /* sample the actual PS/2 clock and data lines */
-    clockInput = (PORTF.IN & PS2_Clock_bm) ? 1 : 0; 
-    dataInput = (PORTF.IN & PS2_Data_bm) ? 1 : 0; 
-    
-    /* perform action based on which clock cycle during a send or receive */
-    switch (clockCount) 
-    {   /* clockCount 0 means we aren't sending or receiving a byte yet */
-        case 0: /* ensure idle state before sending */
-            if (clockInput)
-            { /* PS/2 clockInput is high (not Inhibiting bus!) */
-                /* set sendMode based on Host PS/2 Data line state 
-                   if dataInput is low then it's a Host RQS else we can send */
-                sendMode = dataInput;
-
-                /* Increment Clock count */
-                clockCount++; /* proceed if bus is idle or Host RQS */
-            } else 
-            { /* PS/2 clockInput was low (from Host), so it is Inhibiting bus */
-                /* set sendMode based on Host PS/2 Data line state 
-                   if dataInput is low then it's a Host RQS else we can send (when not Inhibited). */
-                /* Note: Host RQS shouldn't really happen here, unless due to Host signal transition timing */  
-                sendMode = dataInput;
+    input = PORTF.IN;
+
+    /* Bus states: wait for bus idle, then start sending or receiving */
+    if (state < PS2_Transmit)
+    {
+        if ((state == PS2_Idle) || (state == PS2_Inhibit))
+        {
+            /* Between frames, so set the Timer period (from the next period) */
+            period = PS2_ClockHalfPeriod;
+            TCA0.SINGLE.PERBUF = period - 1;
+            TCA0.SINGLE.CMP0BUF = period / 4;
+
+            if (!(input & PS2_Clock_bm))
+                state = PS2_Inhibit;
+            else if (!(input & PS2_Data_bm))
+                state = PS2_RequestToSend;
+            else
+                state = PS2_Ready;
+            return;
+        }
+
+        if (!(input & PS2_Clock_bm))
+        {  /* Host is Inhibiting the bus (again), so start over */
+            state = PS2_Inhibit;
+            return;
+        }
+
+        if (state == PS2_Ready)
+        {
+            if (PS2_KeyEventBufferFlush)
+            {  /* (including any Key Event part sent, as the Host's Reset 
+                *  also restarts its ScanCode decoding) */
+                PS2_KeyEventBuffer_Start = PS2_KeyEventBuffer_End;
+                PS2_KeyEventBufferFlush = false;
+                eventSent = 0;
+#if PS2_QueueStats
+                /* (any latency sample is discarded too) */
+                if (PS2_LatencyState == PS2_LatencySampling)
+                    PS2_LatencyState = PS2_LatencyIdle;
+#endif
             }
-            break;
-        
-        case 1: /* start communication countCount. */
-            if ((clock) && (clockInput))
-            { /* Clock & PS/2 Clock line is high (idle state) */   
-                if (sendMode)
-                {   /* we're in send mode, so see if we have a scanCode to send */ 
-                    if (PS2_ScanCodeBuffer_Start != PS2_ScanCodeBuffer_End)
-                    {  /* There is a scan code to send! */
-                        scanCode = PS2_ScanCodeBuffer[PS2_ScanCodeBuffer_Start];
-                        parityCount = 0;
-
-                        /* Output the start bit (low) */
-                        PORTF.DIRSET = PS2_Data_bm;
-
-                        
-                        _delay_us(DataToClockDelay);
-                        /* issue Clock falling edge */
-                        clock = 0;
-                        PORTF.DIRSET = PS2_Clock_bm;
-                    } else
-                    { /* No character to send, so just reset clockCount to try again! */
-                        clockCount = 0;
-                    }
-                } else
-                {   /* We're in Host receive mode! */
-                    /* initialize (zero) the command byte and parity calculation. */
-                    scanCode = 0;
-                    parityCount = 0;
-
-                    _delay_us(DataToClockDelay);
-                    /* Issue Clock falling edge */
-                    clock = 0;
-                    PORTF.DIRSET = PS2_Clock_bm;
-                }    
+
+            if (PS2_ResponseBuffer_Start != PS2_ResponseBuffer_End)
+            {  /* Command responses are always sent first, even part way 
+                *  through a Key Event's sequence (e.g. E0 FA F0 74). The Host
+                *  takes responses at its Command layer, keeping its E0 / F0
+                *  prefix state, and a Resend must be answered by the last 
+                *  byte before the sequence carries on. Only Reset restarts 
+                *  the Host's decoding, so it discards the rest (see above). */
+                sendingResponse = true;
+                sending = PS2_ResponseBuffer[PS2_ResponseBuffer_Start & PS2_ResponseBuffer_Mask];
+            } else if ((PS2_KeyEventBuffer_Start != PS2_KeyEventBuffer_End)
+                       && (PS2_CommandBuffer_Start == PS2_CommandBuffer_End))
+            {  /* Key Events (unless a received Command awaits its response) */
+                /* Expanded to the next ScanCode of the Key Event's sequence */
+                const uint8_t *sequence = keyEventSequence(
+                    PS2_KeyEventBuffer[PS2_KeyEventBuffer_Start & PS2_KeyEventBuffer_Mask]);
+
+                sendingResponse = false;
+                eventLength = sequence[0];
+                sending = sequence[1 + eventSent];
+#if PS2_QueueStats
+                if ((PS2_LatencyState == PS2_LatencySampling)
+                    && (PS2_KeyEventBuffer_Start == PS2_LatencyEvent))
+                    PS2_LatencyState = PS2_LatencyDone;
+#endif
             } else
-            {   /* clock or PS/2 clockInput is low */
-                /* clock is high but PS/2 clockInput is low */
-                if ((clock) && (clockInput == 0))
-                { /* PS/2 Host inhibit sending interrupt, so abort send! */
-                    /* Release Data line (high) */
-                    PORTF.DIRCLR = PS2_Data_bm;
-                    /* Reset clockCount for Host RTS check */
-                    clockCount = 0;
-                } else
-                {  /* clock is low */
-                    _delay_us(DataToClockDelay);
-                    /* Issue Clock rising edge */
-                    clock = 1;
-                    PORTF.DIRCLR = PS2_Clock_bm;
-
-                    /* Increment Clock count */
-                    clockCount++;
-                }
+            {  /* No byte to send, so just go back to Idle to try again! */
+                state = PS2_Idle;
+#if PS2_TimerIdleStop
+                /* (or rather, stop until there is something to do) */
+                ps2TimerStop();
+#endif
+                return;
             }
-            break;
+            /* There is a byte to send, so build its whole frame */
+            frame = ps2Frame(sending);
+            state = PS2_Transmit;
+        } else 
+            state = PS2_Receive;
         
-        case 2 ... 9: /* data bits */
-            if ((clock) && (clockInput))
-            { /* clock & PS/2 clockInput is high so set or read data bit */   
-                if (sendMode)
-                {  /* if sendMode set data bit */   
-                    if ((scanCode & 0x01) == 1)
-                    {
-                        PORTF.DIRCLR = PS2_Data_bm;
-                        parityCount++;
-                    } else PORTF.DIRSET = PS2_Data_bm;
-                    /* Shift so ready for next data bit */
-                    scanCode >>= 1;
-                } else
-                {  /* Host Receive mode so read bit */
-                    dataInput = (PORTF.IN & PS2_Data_bm) ? 0x80 : 0; 
-                    if (dataInput > 0) parityCount++;
-                    scanCode |= dataInput;
-                    if (clockCount < 9) scanCode >>= 1;
-                }
-                _delay_us(DataToClockDelay);
-                /* Issue Clock falling edge */
-                clock = 0;
-                PORTF.DIRSET = PS2_Clock_bm;
-            } else
-            {  /* clock is high but PS/2 clockInput low */
-                if ((clock) && (clockInput == 0))
-                { /* PS/2 Host inhibit sending interrupt, so abort send! */
-                    /* Release Data line (high) */
-                    PORTF.DIRCLR = PS2_Data_bm;
-                    /* Reset clockCount for Bus inhibit / Host RTS check */
-                    clockCount = 0;
-                } else
-                {  /* Clock is low */
-                    _delay_us(DataToClockDelay);
-                    /* Issue Clock rising edge */
-                    clock = 1;
-                    PORTF.DIRCLR = PS2_Clock_bm;
-
-                    /* Increment Clock count */
-                    clockCount++;
-                }
-            }    
-            break;
-            
-        case 10: /* send parity bit / receive host receive parity bit */
-            if ((clock) && (clockInput))
-            { /* Clock & PS/2 Clock line is high so set the odd parity bit */   
-                if (sendMode)
-                {  /* sendMode so set Parity bit (Odd) */
-                    if (parityCount % 2) PORTF.DIRSET = PS2_Data_bm;
-                    else PORTF.DIRCLR = PS2_Data_bm;
-                } else    
-                {  /* Host Receive mode read parity bit */
-                    dataInput = (PORTF.IN & PS2_Data_bm) ? 1 : 0; 
-                    if ((parityCount % 2) != dataInput)
-                    { /* Valid Parity received */
-
-                        /* We just received a Host Command, so clear ScanCode Buffer */
-                        PS2_ScanCodeBuffer_Start = 0;
-                        PS2_ScanCodeBuffer_End   = 0;
-
-                        PS2_CommandBuffer[PS2_CommandBuffer_End] = scanCode;
-
-                        if (++PS2_CommandBuffer_End == PS2_CommandBuffer_Size)
-                            PS2_CommandBuffer_End = 0;
-
-                        /* If buffer is now full, drop oldest value */
-                        if ((PS2_CommandBuffer_End == PS2_CommandBuffer_Start)
-                            && (++PS2_CommandBuffer_Start == PS2_CommandBuffer_Size))
-                                PS2_CommandBuffer_Start = 0;
-                        
-                    }    
-                }    
-                
-                _delay_us(DataToClockDelay);
-                /* Issue Clock falling edge */
-                clock = 0;
-                PORTF.DIRSET = PS2_Clock_bm;
-            } else
-            {  /* clock is high but PS/2 clockInput is low */
-                if ((clock) && (clockInput == 0))
-                { /* PS/2 Host inhibit sending interrupt, so abort send! */
-                    /* Release Data line (high) */
-                    PORTF.DIRCLR = PS2_Data_bm;
-                    /* Reset clockCount for Host RTS check */
-                    clockCount = 0;
-                } else
-                {  /* Clock is low */
-                    _delay_us(DataToClockDelay);
-                    /* Issue Clock rising edge */
-                    clock = 1;
-                    PORTF.DIRCLR = PS2_Clock_bm;
-
-                    /* Increment Clock count */
-                    clockCount++;
-                }    
+        bits = PS2_States[state].Bits;
+        /* Now the first clock cycle (start bit) of the clocking state */
+    }
+
+    flags = PS2_States[state].Flags;
+
+    if (clock)
+    {  /* Our clock is high, so output or sample a bit, then clock falls */
+        if ((flags & PS2_Inhibitable) && !(input & PS2_Clock_bm))
+        { /* PS/2 Host inhibit sending interrupt, so abort! */
+            /* Release Data line (high) */
+            PORTF.DIRCLR = PS2_Data_bm;
+            state = PS2_Inhibit;
+            return;
+        }
+
+        if (flags & PS2_SendBit)
+        {
+            ps2FrameBit(frame);
+            frame >>= 1;
+        } else
+        {  /* Received bits are shifted in from bit 9 (down to bit 0) */
+            frame >>= 1;
+            if (input & PS2_Data_bm)
+                frame |= (1 << 9);
+        }
+
+        /* Issue Clock falling edge (at Timer compare 0, after this interrupt) */
+        clock = 0;
+        ps2ClockEdge(PS2_Clock_bm, 0);
+        return;
+    }
+
+    /* Our clock is low, so clock rises, and after the last bit, next state */
+    release = PS2_Clock_bm;
+    if (--bits == 0)
+    {
+        if (flags & PS2_ExitRemove)
+        {   /* Now that the byte is sent, remove it from its buffer! */
+            if (sendingResponse)
+                PS2_ResponseBuffer_Start++;
+            else if (++eventSent == eventLength)
+            {  /* Whole sequence sent, so the Key Event is done */
+                eventSent = 0;
+                PS2_KeyEventBuffer_Start++;
             }
-            break;
+            PS2_LastSent = sending;
+            PS2_SentCount++;
+        }
 
-        case 11: /* send stop bit or host receive Acknowledge bit */
-            /* Note: We don't check for the Host pulling clock low here
-             * as some Host's pull clock low straight after the parity bit,
-             * so we just go ahead with sending the expected stop / ack bit  */
-            if (clock)
-            { /* clock is high (PS/2 clockInput is supposed to be high) */   
-                if (sendMode)
-                {
-                    /* Output stop bit (high) */
-                    PORTF.DIRCLR = PS2_Data_bm;
-                } else   
+        if (flags & PS2_ExitCommand)
+        {   /* Received frame is start bit, 8 data bits, and parity bit (bit 9) */
+            command = (uint8_t)(frame >> 1);
+            if (ps2Parity(command) != ((frame >> 9) & 0x01))
+            { /* Valid Parity received */
+                /* Unless the buffer is full (then drop this newest value) */
+                if ((uint8_t)(PS2_CommandBuffer_End - PS2_CommandBuffer_Start) != PS2_CommandBuffer_Size)
                 {
-                    /* Output Ack bit (low) */
-                    PORTF.DIRSET = PS2_Data_bm;
-                }
-                _delay_us(DataToClockDelay);
-                /* Issue Clock falling edge */
-                clock = 0;
-                PORTF.DIRSET = PS2_Clock_bm;
-            } else
-            {  /* Clock is low */
-                _delay_us(DataToClockDelay);
-                /* Issue Clock rising edge */
-                clock = 1;
-                PORTF.DIRCLR = PS2_Clock_bm;
-                /* Release Data line (high) */
-                PORTF.DIRCLR = PS2_Data_bm;
-
-                if (sendMode)
-                {    
-                    /* Now that the ScanCode is sent, remove it from the buffer! */
-                    if (++PS2_ScanCodeBuffer_Start == PS2_ScanCodeBuffer_Size)
-                        PS2_ScanCodeBuffer_Start = 0;
-                }
+                    PS2_CommandBuffer[PS2_CommandBuffer_End & PS2_CommandBuffer_Mask] = command;
+                    PS2_CommandBuffer_End++;
+#if PS2_QueueStats
+                    if ((uint8_t)(PS2_CommandBuffer_End - PS2_CommandBuffer_Start) > PS2_CommandHighWater)
+                        PS2_CommandHighWater = (uint8_t)(PS2_CommandBuffer_End - PS2_CommandBuffer_Start);
+#endif
+                } else if (PS2_CommandDropCount != 0xFF)
+                    PS2_CommandDropCount++;
+            }
+            /* Then send the Ack bit (low), from the frame */
+            frame = 0;
+        }
 
-                /* Increment Clock count */
-                clockCount++;
-            }    
-            break;
-            
-        /* we've just finished a packet so reset clockCount to start again. */    
-        default: 
-            clockCount = 0;
+        if (flags & PS2_ExitRelease)
+            release |= PS2_Data_bm;
+
+        state = PS2_States[state].Next;
+        bits = PS2_States[state].Bits;
     }
+
+    /* Issue Clock rising edge (at Timer compare 0, after this interrupt) */
+    clock = 1;
+    ps2ClockEdge(0, release);
+}
+
+/*
+ * The PS/2 Timer Interrupt's vector number, as the (absolute) symbol 
+ * PS2_TimerVector, for tools/isrwcet.py to find the ISR (__vector_N) by.
+ */
+#define PS2_Stringify(value) #value
+#define PS2_String(value) PS2_Stringify(value)
+__asm__(".global PS2_TimerVector\n\t.set PS2_TimerVector, " PS2_String(TCA0_OVF_vect_num));
+
+#if PS2_DirectVector
+/*
+ * Timer Overflow Interrupt - INTERRUPT SERVICE ROUTINE!
+ * The PS/2 Timer Interrupt code, inlined directly into the ISR.
+ */
+ISR(TCA0_OVF_vect)
+{
+    TCA0_OverflowInterrupt();
+
+    TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
 }
+#endif
 
 /*
  * Main Application
@@ -506,16 +2049,49 @@ int main(void)
     /* MCC defined System Setup (initialize) */
     SYSTEM_Initialize();
 
+#if PS2_DirectVector
+    /* Enable the Timer overflow interrupt, for our own ISR(TCA0_OVF_vect) */
+    TCA0.SINGLE.INTCTRL |= TCA_SINGLE_OVF_bm;
+#else
     /* Setup Timer Interrupt Handler routine */
     Timer->TimeoutCallbackRegister(TCA0_OverflowInterrupt);
+#endif
+
+#if KeyboardIdleSleep
+    /* Setup column pin change Interrupt Handler routines */
+    IO_PD0_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD1_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD2_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD3_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD4_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD5_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD6_SetInterruptHandler(keyboardWakeInterrupt);
+    IO_PD7_SetInterruptHandler(keyboardWakeInterrupt);
+#endif
+#if PS2_TimerIdleStop
+    /* Setup PS/2 Data line pin change Interrupt Handler routine */
+    IO_PF1_SetInterruptHandler(ps2DataInterrupt);
+#endif
    
     /* Initialize key switch arrays to switches Off / Zero de-bounce count */    
     for (uint8_t r = 0; r < MatrixRows; r++)
-        for (uint8_t c = 0; c < MatrixCols; c++)
-        {    
-            KeyswitchDebounce[r][c] = 0;
-            KeyswitchReleased[r][c] = true;
-        }
+    {
+        for (uint8_t b = 0; b < DebounceCountBits; b++)
+            KeyswitchDebounce[r][b] = 0;
+        KeyswitchReleased[r] = 0xFF;
+        KeyswitchLastRow[r] = 0xFF;
+        KeyswitchInFlight[r] = 0;
+#if DebounceEager && GhostDetect
+        KeyswitchPressHeld[r] = 0;
+#endif
+    }
+#if DebounceAdaptive
+    /* Start with the full de-bounce interval, for every key switch */
+    debounceWindowsReset();
+#endif
+#if ScanStats
+    scanStatsClear();
+#endif
 
     /* The following is initialized by MCC, but we also do it here for clarity! */
     /* Initialize PS/2 Port as inputs (PS/2 bus idle state) */ 
@@ -525,10 +2101,37 @@ int main(void)
     PORTF.OUTCLR = PS2_Clock_bm;
     PORTF.OUTCLR = PS2_Data_bm;
     
+    /* Timer period for the default PS/2 clock rate (also initialized by MCC), 
+       and when the Timer compare 0 interrupt issues scheduled PS/2 clock edges */
+    TCA0.SINGLE.PER = PS2_ClockHalfPeriodTicks(PS2_ClockRateDefault) - 1;
+    TCA0.SINGLE.CMP0 = PS2_ClockHalfPeriodTicks(PS2_ClockRateDefault) / 4;
+
+    /* Start TimeBase free running (periodic mode, maximum period) */
+    TimeBase.CCMP = 0xFFFF;
+    TimeBase.CTRLB = TCB_CNTMODE_INT_gc;
+    TimeBase.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+
+    /* Drive the first Keyboard matrix row, ready for the first scan */
+    scanRowDrive(0);
+
+#if ScanTimerDriven
+    /* Start ScanTimer (periodic interrupt mode, ScanTimerPeriodUs period) */
+    ScanTimer.CCMP = (ScanTimerPeriodUs * TimeBase_TicksPerUs) - 1;
+    ScanTimer.CTRLB = TCB_CNTMODE_INT_gc;
+    ScanTimer.INTCTRL = TCB_CAPT_bm;
+    ScanTimer.CTRLA = TCB_CLKSEL_DIV2_gc | TCB_ENABLE_bm;
+#endif
+    
     /* Let's do this forever! */
     while(1)
     {
-        scanKeyboard();
+#if KeyboardIdleSleep
+        /* If no keys are pressed after a full scan, Idle until one is */
+        if (scanKeyboardTask() && keyboardSettled())
+            keyboardIdle();
+#else
+        scanKeyboardTask();
+#endif
         processCommand();
     }    
 }
@@ -0,0 +1,55 @@
+"""
+CreatiVision Keyboard built image helpers
+-----------------------------------------
+
+Shared by the post build checks (isrwcet.py, footprint.py), including their
+common policy: a check fails (exit status 1) if it can't be run (e.g. the
+image or a tool isn't found), or the image is over budget. With --optional,
+each of those is only reported as a warning (exit status 0).
+"""
+import os
+import struct
+import sys
+
+
+def run_check(check):
+    """Run check(arguments), from the command line, with the common policy.
+    check() exits with a reason (starting '<tool>: ') if it fails."""
+    arguments = sys.argv[1:]
+    optional = '--optional' in arguments
+    if optional:
+        arguments.remove('--optional')
+    try:
+        check(arguments)
+    except SystemExit as failure:
+        if not optional or not isinstance(failure.code, str):
+            raise
+        tool, _, reason = failure.code.partition(': ')
+        print('%s: WARNING %s' % (tool, reason))
+
+
+def find_image(path):
+    """The image itself, or the most recently built image (.elf) under a directory."""
+    if not os.path.isdir(path):
+        return path if os.path.isfile(path) else None
+    images = [os.path.join(directory, name)
+              for directory, _, names in os.walk(path) for name in names if name.endswith('.elf')]
+    return max(images, key=os.path.getmtime) if images else None
+
+
+def section_sizes(image):
+    """Return {name: size} of the image's ELF sections, or None if not an ELF image."""
+    with open(image, 'rb') as elf:
+        data = elf.read()
+    if data[:4] != b'\x7fELF':
+        return None
+    # ELF class (32 / 64 bit) and byte order pick the header layouts
+    order = '<' if data[5] == 1 else '>'
+    if data[4] == 1:
+        header, section = order + '32xI10xHHH', order + 'IIIIIIIIII'
+    else:
+        header, section = order + '40xQ10xHHH', order + 'IIQQQQIIQQ'
+    shoff, shentsize, shnum, shstrndx = struct.unpack_from(header, data, 0)
+    sections = [struct.unpack_from(section, data, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx][4]
+    return {data[names + s[0]:data.index(b'\0', names + s[0])].decode(): s[5] for s in sections}
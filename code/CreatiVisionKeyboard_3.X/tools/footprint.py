@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+CreatiVision Keyboard SRAM / flash footprint report
+---------------------------------------------------
+
+Reports the SRAM and flash used by the built image, from its section sizes,
+and by each symbol, from its symbol table (avr-nm), against a budget (by default the AVR32EA28's 4KB SRAM
+and 32KB flash). The full per-symbol report is written next to the image
+(<image>.footprint.txt), with a summary printed, including the smallest AVR EA
+part the image would fit.
+
+  SRAM  = initialised (.data) and uninitialised (.bss, .noinit) variables.
+  Flash = code (.text), constants (.rodata), and .data initial values.
+Code and data without a symbol size (e.g. the vector table, and crt / libgcc
+code) is reported as a single line, so the totals are the section sizes.
+N.B. SRAM excludes the stack (which gets whatever SRAM is left), so a stack
+ reserve is kept free of variables, in the budget and in each part.
+
+Fails (exit status 1) if either is over budget, or avr-nm (or the image)
+can't be found. With --optional, each of those is only reported as a warning
+(exit status 0), as for isrwcet.py.
+
+Usage: footprint.py [--optional] <avr-nm> <SRAM budget bytes> <stack reserve bytes> <flash budget bytes> <image.elf or directory>
+"""
+import os
+import subprocess
+import sys
+
+from buildimage import find_image, run_check, section_sizes
+
+# AVR EA parts (smallest first), as (name, SRAM bytes, flash bytes)
+PARTS = (('AVR8EA', 1024, 8192), ('AVR16EA', 2048, 16384),
+         ('AVR32EA', 4096, 32768), ('AVR64EA', 6144, 65536))
+
+# avr-nm symbol types, and ELF sections, by where they use memory
+SRAM_TYPES = 'BbDdVv'
+FLASH_TYPES = 'TtWwRrDdVv'
+SRAM_SECTIONS = ('.data', '.bss', '.noinit')
+FLASH_SECTIONS = ('.text', '.rodata', '.data')
+UNSIZED = '(no symbol size, e.g. vector table, crt / libgcc code)'
+
+
+def symbols(nm, image):
+    """Return [(name, type, size)] of the image's sized symbols."""
+    listing = subprocess.run([nm, '-S', '--size-sort', image], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    found = []
+    for line in listing.splitlines():
+        fields = line.split()
+        if len(fields) == 4:
+            found.append((fields[3], fields[2], int(fields[1], 16)))
+    return found
+
+
+def table(title, used, budget, sections):
+    """Report lines for the symbols using a memory, largest first, and its total."""
+    total = sum(size for _, size in used)
+    if sections is not None and sections > total:
+        used = used + [(UNSIZED, sections - total)]
+        total = sections
+    lines = ['%s: %d of %d bytes (%d%%)' % (title, total, budget, 100 * total // budget)]
+    lines += ['  %6d  %s' % (size, name) for name, size in sorted(used, key=lambda u: -u[1])]
+    return total, lines
+
+
+def check(arguments):
+    """Run the report, exiting with the reason if it fails."""
+    if len(arguments) != 5:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        sys.exit(2)
+    nm, sram_budget, stack, flash_budget, path = (arguments[0], int(arguments[1]), int(arguments[2]),
+                                                  int(arguments[3]), arguments[4])
+    if not 0 <= stack < sram_budget:
+        sys.exit('footprint: stack reserve (%d bytes) must be 0 or more, and less than the SRAM budget (%d bytes)'
+                 % (stack, sram_budget))
+    if flash_budget <= 0:
+        sys.exit('footprint: flash budget (%d bytes) must be more than 0' % flash_budget)
+
+    image = find_image(path)
+    if image is None:
+        sys.exit('footprint: no image found in %s, not reported' % path)
+    try:
+        found = symbols(nm, image)
+    except OSError:
+        sys.exit('footprint: %s not found, not reported' % nm)
+
+    sizes = section_sizes(image)
+    if sizes is None:
+        print('footprint: WARNING %s is not an ELF image, symbols without a size are not counted' % image)
+
+    sram, sram_lines = table('SRAM', [(name, size) for name, kind, size in found
+                                      if kind in SRAM_TYPES], sram_budget - stack,
+                             sum(sizes.get(name, 0) for name in SRAM_SECTIONS) if sizes else None)
+    flash, flash_lines = table('Flash', [(name, size) for name, kind, size in found
+                                         if kind in FLASH_TYPES], flash_budget,
+                               sum(sizes.get(name, 0) for name in FLASH_SECTIONS) if sizes else None)
+    fits = [name for name, part_sram, part_flash in PARTS
+            if sram + stack <= part_sram and flash <= part_flash]
+
+    report = image + '.footprint.txt'
+    with open(report, 'w') as output:
+        output.write('\n'.join(sram_lines + [''] + flash_lines) + '\n')
+    print('footprint: %s SRAM %d of %d bytes (%d reserved for the stack), flash %d of %d bytes,'
+          ' smallest AVR EA part %s (see %s)'
+          % (os.path.basename(image), sram, sram_budget - stack, stack, flash, flash_budget,
+             fits[0] if fits else 'none', report))
+    if sram + stack > sram_budget or flash > flash_budget:
+        sys.exit('footprint: %s is OVER budget!' % os.path.basename(image))
+
+
+if __name__ == '__main__':
+    run_check(check)
@@ -0,0 +1,1151 @@
+/*
+ * CreatiVision Keyboard host simulation
+ * -------------------------------------
+ *
+ * Builds the Keyboard firmware (main.c, unchanged) for the host, against the
+ * stand-in MCC / AVR headers in include/, with simple models of the parts of
+ * the AVR32EA28 it uses, of the Keyboard matrix, and of a PS/2 Host:
+ *  - Time is counted in System Clock cycles (F_CPU). Each register access by
+ *      the firmware (and each loop iteration) takes a few cycles, and the
+ *      interrupts (TCA0, TCB0, PORTD / PORTF pin change) are run as they fall
+ *      due, between the firmware's register accesses.
+ *  - The Keyboard matrix has no diodes, so a column reads low when it is
+ *      connected to a driven row through any path of closed key switches
+ *      (i.e. ghost keys appear, just as on the real matrix).
+ *  - The PS/2 Host receives every frame (checking its framing and parity),
+ *      and can send Commands (Request To Send, then clocked by the Keyboard).
+ * Each simulation run is a fresh process (fork), running firmware main() from
+ * reset, for a scripted set of key switch changes and Host Commands.
+ *
+ * Usage: hostsim test | bench | latency
+ *  test  = Key, ghost and PS/2 protocol tests (exit status 1 if any fail).
+ *  latency = key press / release latency, until the Key Event is queued, and
+ *      until it is received by the Host (for clean and chattering keys).
+ *  bench = host time per Keyboard matrix scan of the de-bounce engine, against
+ *      the v3.0 per key de-bounce. N.B. Host time, NOT AVR cycles (the AVR has
+ *      no cache, branch predictor or multiplier width to match), so only the
+ *      ratio between the two is of interest.
+ * Build options (e.g. -DDebounceEager=1) are set by the Makefile, per variant.
+ */
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mcc_generated_files/system/system.h"
+
+/*
+ * Every firmware loop iteration takes time (waiting for ScanTimer, main()
+ * only reads RAM, so would otherwise wait forever).
+ */
+void hostsimLoop(void);
+#define while(condition) while (hostsimLoop(), (condition))
+#define main firmwareMain
+#include "../../main.c"
+#undef main
+#undef while
+
+#define SimClocksPerUs (F_CPU / 1000000UL)
+#define SimAccessClocks 4       /* Clock cycles per register access */
+#define SimLoopClocks 2         /* Clock cycles per loop iteration */
+
+/*
+ * Simulation state
+ */
+static uint64_t SimClock = 0;           /* Clock cycles since reset */
+static uint64_t SimEndClock = 0;        /* Clock cycle to end the run at */
+static jmp_buf SimEnd;
+static bool SimRunning = false;         /* Firmware is running (time passes) */
+static bool SimInInterrupt = false;
+static bool SimInterruptsEnabled = true;
+static bool SimWoken = false;           /* An interrupt has run (ends sleep) */
+static uint64_t SimIdles[64];           /* Clock cycle of each Keyboard idle */
+static unsigned SimIdleCount = 0;
+
+/*
+ * Peripherals (PORTA = rows, PORTD = columns, PORTF = PS/2)
+ */
+TCA_t TCA0;
+static PORT_t SimPorts[3];
+static TCB_t SimTimers[2];
+static uint8_t SimPortDSense = 0;       /* PORTD pin ISC (from PINCTRLUPD) */
+static uint8_t SimPortDLast = 0xFF;     /* PORTD.IN, for falling edges */
+static uint8_t SimPortFLast = 0x03;     /* PS/2 lines, for falling edges */
+static bool SimPendingOverflow = false;
+static bool SimPendingCompare = false;
+static bool SimPendingScanTimer = false;
+static bool SimPendingColumn = false;
+static bool SimPendingData = false;
+static void (*SimTimerCallback)(void) = NULL;
+static void (*SimColumnHandler)(void) = NULL;
+static void (*SimDataHandler)(void) = NULL;
+
+/*
+ * Keyboard matrix, closed key switches (column c is bit c, for each row)
+ * SimSwitchChanges = the scripted key switch changes (in time order).
+ */
+typedef struct
+{
+    uint64_t Clock;
+    uint8_t Position;
+    bool Closed;
+} SimSwitchChange_t;
+
+#define SimSwitchChangesMax 2048
+static uint8_t SimSwitches[MatrixRows];
+static SimSwitchChange_t SimSwitchChanges[SimSwitchChangesMax];
+static unsigned SimSwitchChangeCount = 0;
+static unsigned SimSwitchChangeNext = 0;
+
+/*
+ * PS/2 Host
+ * SimHostPull = the lines the Host is pulling low (PS2_Clock_bm, PS2_Data_bm).
+ * SimHostCommands = the scripted Commands to send (in time order), each sent
+ *      once due, and the Host is not receiving a frame.
+ * SimHostBytes = the bytes received, with the time of their stop bit.
+ */
+typedef struct
+{
+    uint64_t Clock;
+    uint16_t Byte;                      /* SimFrameError_bm if a bad frame */
+} SimHostByte_t;
+
+#define SimHostIdle 0
+#define SimHostInhibit 1
+#define SimHostSend 2
+#define SimHostInhibitUs 100
+#define SimFrameError_bm 0x100
+#define SimHostBytesMax 1024
+
+static uint8_t SimHostPull = 0;
+static uint8_t SimHostState = SimHostIdle;
+static uint64_t SimHostUntil = 0;
+static uint8_t SimHostBits = 0;         /* clock falling edges in the frame */
+static uint16_t SimHostFrame = 0;
+static uint8_t SimHostSending = 0;
+static SimHostByte_t SimHostCommands[64];
+static unsigned SimHostCommandCount = 0;
+static unsigned SimHostCommandNext = 0;
+static unsigned SimHostCommandAfter = 0;   /* bytes received, making the next Command due */
+static SimHostByte_t SimHostBytes[SimHostBytesMax];
+static unsigned SimHostByteCount = 0;
+static unsigned SimHostAckErrors = 0;
+
+/*
+ * Key Events queued by the firmware (KeyEventBuffer), with the time queued.
+ */
+static SimHostByte_t SimKeyEvents[SimHostBytesMax];
+static unsigned SimKeyEventCount = 0;
+static uint8_t SimKeyEventEnd = 0;
+
+/*
+ * v3.0 key Scan Codes (0x00 = no key switch), extended if 0x6B or 0x74, as the
+ * reference for the key tables (generated from keylayout.txt).
+ */
+static const uint8_t SimScanCodes[MatrixRows][MatrixCols]
+                        = {{0x16,0x1E,0x26,0x25,0x2E,0x36,0x00,0x00},
+                           {0x00,0x15,0x1D,0x24,0x2D,0x2C,0x14,0x00},
+                           {0x6B,0x1C,0x1B,0x23,0x2B,0x34,0x00,0x00},
+                           {0x00,0x1A,0x22,0x21,0x2A,0x32,0x00,0x59},
+                           {0x3D,0x3E,0x46,0x45,0x52,0x4E,0x00,0x00},
+                           {0x35,0x3C,0x43,0x44,0x4D,0x5A,0x00,0x00},
+                           {0x33,0x3B,0x42,0x4B,0x4C,0x74,0x00,0x00},
+                           {0x31,0x3A,0x41,0x49,0x4A,0x29,0x00,0x00}};
+
+/*
+ * Key switch contact bounce, as the times (us) the contact changes, from
+ * when it first changes. An odd count, so the contact ends changed.
+ */
+static const uint16_t SimBounceNone[] = {0};
+static const uint16_t SimBounceChatter[] = {0, 150, 300, 600, 700};
+#define SimBounce(pattern) (pattern), (sizeof(pattern) / sizeof((pattern)[0]))
+
+/*
+ * Function to Apply the Port register writes (DIRSET / DIRCLR / OUTSET /
+ * OUTCLR / PINCTRLUPD) made since the last Port access
+ */
+static void simPortsApply(void)
+{
+    /* All rows driven (from some not), is the Keyboard going idle */
+    if ((SimPorts[0].DIRSET == 0xFF) && (SimPorts[0].DIR != 0xFF)
+        && (SimIdleCount < sizeof(SimIdles) / sizeof(SimIdles[0])))
+        SimIdles[SimIdleCount++] = SimClock;
+
+    for (unsigned p = 0; p < 3; p++)
+    {
+        PORT_t *port = &SimPorts[p];
+
+        port->DIR = (port->DIR | port->DIRSET) & ~port->DIRCLR;
+        port->OUT = (port->OUT | port->OUTSET) & ~port->OUTCLR;
+        port->DIRSET = port->DIRCLR = port->OUTSET = port->OUTCLR = 0;
+    }
+    if (SimPorts[1].PINCTRLUPD)
+    {
+        SimPortDSense = SimPorts[1].PINCONFIG & PORT_ISC_gm;
+        SimPorts[1].PINCTRLUPD = 0;
+    }
+}
+
+/*
+ * Function to Return the Keyboard matrix columns (PORTD.IN), from the rows
+ * driven low, through any path of closed key switches.
+ */
+static uint8_t simColumns(void)
+{
+    uint8_t rows = SimPorts[0].DIR & ~SimPorts[0].OUT;
+    uint8_t columns = 0;
+    uint8_t reached;
+
+    do
+    {
+        reached = columns;
+        for (uint8_t r = 0; r < MatrixRows; r++)
+            if (rows & (1 << r)) columns |= SimSwitches[r];
+        for (uint8_t r = 0; r < MatrixRows; r++)
+            if (SimSwitches[r] & columns) rows |= (1 << r);
+    } while (columns != reached);
+
+    return ~columns;
+}
+
+/*
+ * Function to Return the PS/2 lines (PORTF.IN), pulled low by either side
+ */
+static uint8_t simLines(void)
+{
+    return 0x03 & ~(SimPorts[2].DIR & ~SimPorts[2].OUT) & ~SimHostPull;
+}
+
+/*
+ * Function to Run the PS/2 Host, on each bus clock falling edge that the
+ * Keyboard issued (and once a Command is due, start sending it).
+ */
+static void simHost(uint8_t lines, bool clockFell)
+{
+    if (SimHostState == SimHostIdle)
+    {
+        if (clockFell)
+        {  /* Receive start bit, 8 data bits (LSB first), parity, stop bit */
+            SimHostFrame |= ((lines & PIN1_bm) ? 1 : 0) << SimHostBits;
+            if (++SimHostBits == 11)
+            {
+                uint8_t byte = (SimHostFrame >> 1) & 0xFF;
+                bool parity = (__builtin_parity(byte) ^ ((SimHostFrame >> 9) & 1));
+                bool framed = (!(SimHostFrame & 0x001) && (SimHostFrame & 0x400));
+
+                if (SimHostByteCount < SimHostBytesMax)
+                {
+                    SimHostBytes[SimHostByteCount].Clock = SimClock;
+                    SimHostBytes[SimHostByteCount++].Byte
+                                    = byte | ((parity && framed) ? 0 : SimFrameError_bm);
+                }
+                if ((SimHostByteCount == SimHostCommandAfter)
+                    && (SimHostCommandNext < SimHostCommandCount))
+                    SimHostCommands[SimHostCommandNext].Clock = SimClock;
+                SimHostBits = 0;
+                SimHostFrame = 0;
+            }
+        } else if ((SimHostBits == 0) && (SimHostCommandNext < SimHostCommandCount)
+                   && (SimClock >= SimHostCommands[SimHostCommandNext].Clock))
+        {  /* Inhibit (clock low) first, before the Request To Send */
+            SimHostSending = SimHostCommands[SimHostCommandNext++].Byte;
+            SimHostPull = PIN0_bm;
+            SimHostUntil = SimClock + (SimHostInhibitUs * SimClocksPerUs);
+            SimHostState = SimHostInhibit;
+        }
+    } else if (SimHostState == SimHostInhibit)
+    {
+        if (SimClock >= SimHostUntil)
+        {  /* Request To Send: data low (the start bit), then release clock */
+            SimHostPull = PIN1_bm;
+            SimHostBits = 0;
+            SimHostState = SimHostSend;
+        }
+    } else if (clockFell)
+    {  /* Next bit is output after each falling edge, then the ack is read */
+        SimHostBits++;
+        if (SimHostBits <= 8)
+            SimHostPull = (SimHostSending & (1 << (SimHostBits - 1))) ? 0 : PIN1_bm;
+        else if (SimHostBits == 9)
+            SimHostPull = __builtin_parity(SimHostSending) ? PIN1_bm : 0;
+        else if (SimHostBits == 10)
+            SimHostPull = 0;
+        else
+        {
+            if (lines & PIN1_bm)
+                SimHostAckErrors++;
+            SimHostBits = 0;
+            SimHostFrame = 0;
+            SimHostState = SimHostIdle;
+        }
+    }
+}
+
+/*
+ * Function to Run an interrupt handler
+ */
+static void simInterrupt(void (*handler)(void))
+{
+    SimInInterrupt = true;
+    handler();
+    simPortsApply();
+    SimInInterrupt = false;
+    SimWoken = true;
+}
+
+#if PS2_DirectVector
+static void simOverflowVector(void)
+{
+    TCA0_OVF_vect();
+}
+#endif
+
+#if ScanTimerDriven
+static void simScanTimerVector(void)
+{
+    TCB0_INT_vect();
+}
+#endif
+
+static void simCompareVector(void)
+{
+    TCA0_CMP0_vect();
+}
+
+/*
+ * Function to Step the simulation by a clock cycle: timers, key switches and
+ * PS/2 Host, then run any interrupts due (unless disabled, or in one).
+ */
+static void simStep(void)
+{
+    uint8_t lines;
+
+    SimClock++;
+
+    /* PS/2 Timer (TCA0, System Clock), buffered PER / CMP0 at overflow */
+    if (TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm)
+    {
+        if (TCA0.SINGLE.CNT >= TCA0.SINGLE.PER)
+        {
+            TCA0.SINGLE.CNT = 0;
+            if (TCA0.SINGLE.PERBUF)
+            {
+                TCA0.SINGLE.PER = TCA0.SINGLE.PERBUF;
+                TCA0.SINGLE.CMP0 = TCA0.SINGLE.CMP0BUF;
+            }
+            if (TCA0.SINGLE.INTCTRL & TCA_SINGLE_OVF_bm)
+                SimPendingOverflow = true;
+        } else
+            TCA0.SINGLE.CNT++;
+        if ((TCA0.SINGLE.CNT == TCA0.SINGLE.CMP0) && (TCA0.SINGLE.INTCTRL & TCA_SINGLE_CMP0_bm))
+            SimPendingCompare = true;
+    }
+    TCA0.SINGLE.INTFLAGS = 0;
+
+    /* TimeBase (TCB1) and ScanTimer (TCB0), System Clock / 2 */
+    for (unsigned t = 0; t < 2; t++)
+    {
+        TCB_t *timer = &SimTimers[t];
+
+        if ((timer->CTRLA & TCB_ENABLE_bm) && !(SimClock & 1))
+        {
+            if (timer->CNT == timer->CCMP)
+            {
+                timer->CNT = 0;
+                if (timer->INTCTRL & TCB_CAPT_bm)
+                    SimPendingScanTimer = (t == 0);
+            } else
+                timer->CNT++;
+        }
+    }
+
+    /* Key switch changes now due */
+    while ((SimSwitchChangeNext < SimSwitchChangeCount)
+           && (SimSwitchChanges[SimSwitchChangeNext].Clock <= SimClock))
+    {
+        SimSwitchChange_t *change = &SimSwitchChanges[SimSwitchChangeNext++];
+
+        if (change->Closed)
+            SimSwitches[KeyPositionRow(change->Position)] |= RowCol_bm[KeyPositionCol(change->Position)];
+        else
+            SimSwitches[KeyPositionRow(change->Position)] &= ~RowCol_bm[KeyPositionCol(change->Position)];
+    }
+
+    /* Column pin change (falling edge) interrupts */
+    if (SimPortDSense == PORT_ISC_FALLING_gc)
+    {
+        uint8_t columns = simColumns();
+
+        if (SimPortDLast & ~columns)
+            SimPendingColumn = true;
+        SimPortDLast = columns;
+    } else
+        SimPortDLast = 0xFF;
+
+    /* PS/2 Host, and PS/2 Data line pin change (falling edge) interrupt */
+    lines = simLines();
+    simHost(lines, (SimPortFLast & PIN0_bm) && !(lines & PIN0_bm) && !(SimHostPull & PIN0_bm));
+    lines = simLines();
+    if ((SimPortFLast & PIN1_bm) && !(lines & PIN1_bm)
+        && ((SimPorts[2].PIN1CTRL & PORT_ISC_gm) == PORT_ISC_FALLING_gc))
+        SimPendingData = true;
+    SimPortFLast = lines;
+
+    /* Key Events queued */
+    while (SimKeyEventEnd != PS2_KeyEventBuffer_End)
+    {
+        if (SimKeyEventCount < SimHostBytesMax)
+        {
+            SimKeyEvents[SimKeyEventCount].Clock = SimClock;
+            SimKeyEvents[SimKeyEventCount++].Byte
+                            = PS2_KeyEventBuffer[SimKeyEventEnd & PS2_KeyEventBuffer_Mask];
+        }
+        SimKeyEventEnd++;
+    }
+
+    if (SimInInterrupt || !SimInterruptsEnabled)
+        return;
+
+    if (SimPendingOverflow)
+    {
+        SimPendingOverflow = false;
+#if PS2_DirectVector
+        simInterrupt(simOverflowVector);
+#else
+        if (SimTimerCallback) simInterrupt(SimTimerCallback);
+#endif
+    }
+    if (SimPendingCompare && (TCA0.SINGLE.INTCTRL & TCA_SINGLE_CMP0_bm))
+        simInterrupt(simCompareVector);
+    SimPendingCompare = false;
+#if ScanTimerDriven
+    if (SimPendingScanTimer)
+        simInterrupt(simScanTimerVector);
+#endif
+    SimPendingScanTimer = false;
+    if (SimPendingColumn && SimColumnHandler)
+        simInterrupt(SimColumnHandler);
+    SimPendingColumn = false;
+    if (SimPendingData && SimDataHandler)
+        simInterrupt(SimDataHandler);
+    SimPendingData = false;
+
+    /* End of the run (only ever outside an interrupt) */
+    if (SimClock >= SimEndClock)
+        longjmp(SimEnd, 1);
+}
+
+/*
+ * Function to Pass time in the firmware (not while in an interrupt)
+ */
+static void simPass(unsigned clocks)
+{
+    if (!SimRunning || SimInInterrupt)
+        return;
+    while (clocks--)
+        simStep();
+}
+
+/*
+ * Stand-in header functions (register access, interrupts, sleep, MCC)
+ */
+PORT_t *hostsimPort(uint8_t port)
+{
+    simPortsApply();
+    simPass(SimAccessClocks);
+    simPortsApply();
+    if (port == 1)
+        SimPorts[1].IN = simColumns();
+    else if (port == 2)
+        SimPorts[2].IN = simLines();
+    return &SimPorts[port];
+}
+
+TCB_t *hostsimTimer(uint8_t timer)
+{
+    simPortsApply();
+    simPass(SimAccessClocks);
+    return &SimTimers[timer];
+}
+
+void hostsimInterrupts(bool enable)
+{
+    SimInterruptsEnabled = enable;
+}
+
+void hostsimLoop(void)
+{
+    simPass(SimLoopClocks);
+}
+
+void hostsimSleep(void)
+{
+    SimWoken = false;
+    while (!SimWoken)
+        simPass(1);
+}
+
+static void simTimeoutCallbackRegister(void (*callback)(void))
+{
+    SimTimerCallback = callback;
+}
+
+const struct TMR_INTERFACE TCA0_Interface = {simTimeoutCallbackRegister};
+
+void SYSTEM_Initialize(void)
+{
+    /* As MCC: PS/2 Timer running at 40us, with its overflow interrupt */
+    TCA0.SINGLE.PER = PS2_ClockHalfPeriodTicks(PS2_ClockRateDefault) - 1;
+    TCA0.SINGLE.CTRLA = TCA_SINGLE_ENABLE_bm;
+#if !PS2_DirectVector
+    TCA0.SINGLE.INTCTRL = TCA_SINGLE_OVF_bm;
+#endif
+}
+
+#define SIM_IO_HANDLER(pin, handler) \
+    void IO_##pin##_SetInterruptHandler(void (*callback)(void)) { handler = callback; }
+SIM_IO_HANDLER(PD0, SimColumnHandler)
+SIM_IO_HANDLER(PD1, SimColumnHandler)
+SIM_IO_HANDLER(PD2, SimColumnHandler)
+SIM_IO_HANDLER(PD3, SimColumnHandler)
+SIM_IO_HANDLER(PD4, SimColumnHandler)
+SIM_IO_HANDLER(PD5, SimColumnHandler)
+SIM_IO_HANDLER(PD6, SimColumnHandler)
+SIM_IO_HANDLER(PD7, SimColumnHandler)
+SIM_IO_HANDLER(PF1, SimDataHandler)
+
+/*
+ * Scripting functions, for the key switches and Host Commands of a run
+ */
+static void simSwitch(uint64_t us, uint8_t position, bool closed)
+{
+    SimSwitchChange_t *change;
+    unsigned i = SimSwitchChangeCount++;
+
+    if (SimSwitchChangeCount > SimSwitchChangesMax)
+    {
+        fprintf(stderr, "hostsim: too many key switch changes\n");
+        exit(2);
+    }
+
+    /* Keep the changes in time order */
+    for (; (i > 0) && (SimSwitchChanges[i - 1].Clock > us * SimClocksPerUs); i--)
+        SimSwitchChanges[i] = SimSwitchChanges[i - 1];
+    change = &SimSwitchChanges[i];
+    change->Clock = us * SimClocksPerUs;
+    change->Position = position;
+    change->Closed = closed;
+}
+
+static void simKey(uint64_t us, uint8_t position, bool press, const uint16_t *bounce, unsigned changes)
+{
+    for (unsigned i = 0; i < changes; i++)
+        simSwitch(us + bounce[i], position, (i & 1) ? !press : press);
+}
+
+static void simCommand(uint64_t us, uint8_t command)
+{
+    SimHostCommands[SimHostCommandCount].Clock = us * SimClocksPerUs;
+    SimHostCommands[SimHostCommandCount++].Byte = command;
+}
+
+/* Send a Command as soon as a number of bytes have been received */
+static void simCommandAfter(unsigned bytes, uint8_t command)
+{
+    SimHostCommandAfter = bytes;
+    simCommand(UINT64_MAX / SimClocksPerUs, command);
+}
+
+/*
+ * Function to Run the firmware from reset, for a time (us)
+ */
+static void simRun(uint64_t us)
+{
+    SimEndClock = SimClock + (us * SimClocksPerUs);
+    SimRunning = true;
+    if (!setjmp(SimEnd))
+        firmwareMain();
+    SimRunning = false;
+}
+
+/*
+ * Function to Run a test (or benchmark), in its own process, so that each
+ * starts with the firmware in its reset state.
+ * Returns true if it passed.
+ */
+static bool simFork(const char *name, bool (*run)(void))
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+        exit(run() ? 0 : 1);
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid))
+    {
+        fprintf(stderr, "hostsim: can't run %s\n", name);
+        return false;
+    }
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+/*
+ * Test checking functions
+ */
+static bool simExpect(const char *name, const uint16_t *expected, unsigned count)
+{
+    unsigned i;
+
+    for (i = 0; (i < count) && (i < SimHostByteCount); i++)
+        if (SimHostBytes[i].Byte != expected[i])
+            break;
+    if ((i == count) && (count == SimHostByteCount) && (SimHostAckErrors == 0))
+        return true;
+
+    printf("FAIL %s: byte %u of %u (%u received, %u ack errors), expected", name, i,
+           count, SimHostByteCount, SimHostAckErrors);
+    for (unsigned j = i; (j < count) && (j < i + 8); j++)
+        printf(" %02X", expected[j]);
+    printf(", received");
+    for (unsigned j = i; (j < SimHostByteCount) && (j < i + 8); j++)
+        printf(" %0*X", (SimHostBytes[j].Byte & SimFrameError_bm) ? 3 : 2, SimHostBytes[j].Byte);
+    printf("\n");
+    return false;
+}
+
+/* Add a key's v3.0 make or break Scan Codes to the expected bytes */
+static unsigned simExpectKey(uint16_t *expected, unsigned count, uint8_t position, bool press)
+{
+    uint8_t code = SimScanCodes[KeyPositionRow(position)][KeyPositionCol(position)];
+
+    if ((code == 0x6B) || (code == 0x74))
+        expected[count++] = 0xE0;
+    if (!press)
+        expected[count++] = 0xF0;
+    expected[count++] = code;
+    return count;
+}
+
+#define SimKeyGapUs 15000
+
+/*
+ * Test: every key, pressed then released (each with chatter), one at a time,
+ * sends its v3.0 make then break Scan Codes (and nothing else).
+ */
+static bool testEveryKey(void)
+{
+    static uint16_t expected[SimHostBytesMax];
+    unsigned count = 0;
+    uint64_t us = 1000;
+
+    for (uint8_t p = 0; p < MatrixRows * MatrixCols; p++)
+    {
+        if (SimScanCodes[KeyPositionRow(p)][KeyPositionCol(p)] == 0x00)
+            continue;
+        simKey(us, p, true, SimBounce(SimBounceChatter));
+        simKey(us + SimKeyGapUs, p, false, SimBounce(SimBounceChatter));
+        count = simExpectKey(expected, count, p, true);
+        count = simExpectKey(expected, count, p, false);
+        us += 2 * SimKeyGapUs;
+    }
+    simRun(us);
+    return simExpect("every key", expected, count);
+}
+
+/*
+ * Test: key tables match the v3.0 Scan Codes, for every matrix position
+ * (including positions with no key switch, which must send nothing).
+ */
+static bool testKeyTables(void)
+{
+    uint16_t expected[4];
+    const uint8_t *sequence;
+    unsigned count;
+    bool passed = true;
+
+    for (uint8_t p = 0; p < MatrixRows * MatrixCols; p++)
+    {
+        bool fitted = (SimScanCodes[KeyPositionRow(p)][KeyPositionCol(p)] != 0x00);
+
+        if (fitted != ((PS2_KeyValid_bm[KeyPositionRow(p)] & RowCol_bm[KeyPositionCol(p)]) != 0))
+            passed = false;
+        for (uint8_t pressed = 0; pressed < 2; pressed++)
+        {
+            count = fitted ? simExpectKey(expected, 0, p, pressed) : 0;
+            sequence = keyEventSequence(p | (pressed ? 0 : PS2_KeyEventBreak_bm));
+            if (sequence[0] != count)
+                passed = false;
+            for (unsigned i = 0; (i < count) && (i < sequence[0]); i++)
+                if (sequence[1 + i] != expected[i])
+                    passed = false;
+        }
+    }
+    if (!passed)
+        printf("FAIL key tables: don't match the v3.0 Scan Codes\n");
+    return passed;
+}
+
+/*
+ * Test: PS/2 Commands, Identify, Echo, Diagnostics page 1 and Resend, each
+ * sent once the previous response has been received.
+ */
+static bool testCommands(void)
+{
+    static const uint16_t expected[] = {0xFA, 0xAB, 0x83, 0xEE, 0xFA, 0xFA,
+                                        0x04, PS2_ClockRateDefault, 0x00, 0x00, 0x00, 0x00};
+
+    simCommand(1000, 0xF2);
+    simCommand(6000, 0xEE);
+    simCommand(10000, PS2_DiagnosticsCommand);
+    simCommand(14000, DiagnosticsPagePS2Clock);
+    simCommand(24000, 0xFE);
+    simRun(30000);
+    return simExpect("commands", expected, sizeof(expected) / sizeof(expected[0]));
+}
+
+/*
+ * Test: Diagnostics page 3 (learnt de-bounce intervals), from reset every key
+ * switch has the full interval (DebounceCount), or it's empty (length 0) if
+ * not DebounceAdaptive.
+ */
+static bool testDiagnosticsDebounce(void)
+{
+    static uint16_t expected[3 + PS2_KeyCount];
+    unsigned count = 0;
+
+    expected[count++] = 0xFA;
+    expected[count++] = 0xFA;
+#if DebounceAdaptive
+    expected[count++] = PS2_KeyCount;
+    for (unsigned k = 0; k < PS2_KeyCount; k++)
+        expected[count++] = DebounceCount;
+#else
+    expected[count++] = 0;
+#endif
+    simCommand(1000, PS2_DiagnosticsCommand);
+    simCommand(4000, DiagnosticsPageDebounce);
+    simRun(60000);
+    return simExpect("diagnostics debounce", expected, count);
+}
+
+/*
+ * Test: holding (1,1), (1,2), then (2,1), a ghost pattern, makes (2,2) appear
+ * pressed too. Neither (2,1) nor the phantom (2,2) is sent (in every variant),
+ * and the pattern is counted once (Diagnostics page 4, so (2,1) is pressed
+ * and released without chatter).
+ */
+static bool testGhostPhantom(void)
+{
+    static uint16_t expected[16];
+    unsigned count = 0;
+
+    simKey(1000, KeyPosition(1, 1), true, SimBounce(SimBounceChatter));
+    simKey(6000, KeyPosition(1, 2), true, SimBounce(SimBounceChatter));
+    simKey(11000, KeyPosition(2, 1), true, SimBounce(SimBounceNone));
+    simKey(21000, KeyPosition(2, 1), false, SimBounce(SimBounceNone));
+    simKey(31000, KeyPosition(1, 2), false, SimBounce(SimBounceChatter));
+    simKey(36000, KeyPosition(1, 1), false, SimBounce(SimBounceChatter));
+    simCommand(46000, PS2_DiagnosticsCommand);
+    simCommand(50000, DiagnosticsPageGhosts);
+
+    count = simExpectKey(expected, count, KeyPosition(1, 1), true);
+    count = simExpectKey(expected, count, KeyPosition(1, 2), true);
+    count = simExpectKey(expected, count, KeyPosition(1, 2), false);
+    count = simExpectKey(expected, count, KeyPosition(1, 1), false);
+    expected[count++] = 0xFA;
+    expected[count++] = 0xFA;
+    expected[count++] = 0x02;
+    expected[count++] = 0x01;
+    expected[count++] = 0x00;
+    simRun(60000);
+    return simExpect("ghost phantom", expected, count);
+}
+
+/*
+ * Test: while ghosting holds back key presses (3 keys of a ghost pattern 
+ * pressed at once), the Keyboard doesn't idle (it would be woken straight
+ * away), and does once they are released. No key is sent.
+ */
+static bool testGhostNoIdle(void)
+{
+    static const uint8_t keys[] = {KeyPosition(1, 1), KeyPosition(1, 2), KeyPosition(2, 1)};
+    unsigned holding = 0;
+    unsigned released = 0;
+
+    for (unsigned k = 0; k < sizeof(keys); k++)
+    {
+        simKey(1000, keys[k], true, SimBounce(SimBounceNone));
+        simKey(21000, keys[k], false, SimBounce(SimBounceNone));
+    }
+    simRun(30000);
+
+    for (unsigned i = 0; i < SimIdleCount; i++)
+    {
+        if ((SimIdles[i] >= 2000 * SimClocksPerUs) && (SimIdles[i] < 21000 * SimClocksPerUs))
+            holding++;
+        else if (SimIdles[i] >= 21000 * SimClocksPerUs)
+            released++;
+    }
+    if (holding || !released || SimHostByteCount)
+    {
+        printf("FAIL ghost no idle: %u idles while holding, %u once released, %u bytes sent\n",
+               holding, released, SimHostByteCount);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Test: a Reset received part way through a key's break sequence (just after
+ * its E0) discards the rest of it, so the Host's decoding (restarted by its
+ * Reset) never sees a phantom break (E0 FA AA F0 74).
+ */
+static bool testResetMidSequence(void)
+{
+    static uint16_t expected[8];
+    unsigned count = 0;
+
+    simKey(1000, KeyPosition(6, 5), true, SimBounce(SimBounceNone));
+    simKey(16000, KeyPosition(6, 5), false, SimBounce(SimBounceNone));
+    count = simExpectKey(expected, count, KeyPosition(6, 5), true);
+    expected[count++] = 0xE0;
+    simCommandAfter(count, 0xFF);
+    expected[count++] = 0xFA;
+    expected[count++] = 0xAA;
+    simRun(40000);
+    return simExpect("reset mid sequence", expected, count);
+}
+
+/*
+ * Test: a key pressed while a Command is being answered is sent after the
+ * Command's response (and the Command is answered).
+ */
+static bool testKeyDuringCommand(void)
+{
+    static uint16_t expected[8];
+    unsigned count = 0;
+
+    simCommand(1000, 0xF2);
+    simKey(1000, KeyPosition(2, 0), true, SimBounce(SimBounceNone));
+    expected[count++] = 0xFA;
+    expected[count++] = 0xAB;
+    expected[count++] = 0x83;
+    count = simExpectKey(expected, count, KeyPosition(2, 0), true);
+    simRun(20000);
+    return simExpect("key during command", expected, count);
+}
+
+/*
+ * Benchmark: the v3.0 per key de-bounce (a count and state for each key,
+ * every key visited every scan), emitting the same one byte Key Events.
+ */
+static uint8_t RefDebounce[MatrixRows][MatrixCols];
+static bool RefReleased[MatrixRows][MatrixCols];
+static uint8_t RefEvents[PS2_KeyEventBuffer_Size];
+static uint8_t RefEvents_Start = 0;
+static uint8_t RefEvents_End = 0;
+static uint16_t RefDropCount = 0;
+
+static void refEventAdd(uint8_t event)
+{
+    if ((uint8_t)(RefEvents_End - RefEvents_Start) == PS2_KeyEventBuffer_Size)
+    {
+        RefDropCount++;
+        return;
+    }
+    RefEvents[RefEvents_End & PS2_KeyEventBuffer_Mask] = event;
+    RefEvents_End++;
+}
+
+static void refKeyboardRow(uint8_t r, uint8_t matrix_row)
+{
+    bool keySwitchStatus;
+
+    for (uint8_t c = 0; c < MatrixCols; c++)
+    {
+        if (RefDebounce[r][c] > 1)
+        {
+            RefDebounce[r][c]--;
+        } else
+        {
+            keySwitchStatus = (matrix_row & RowCol_bm[c]);
+
+            if (RefDebounce[r][c] == 1)
+            {
+                if ((keySwitchStatus == RefReleased[r][c])
+                    && (PS2_KeyValid_bm[r] & RowCol_bm[c]))
+                    refEventAdd(KeyPosition(r, c) | (keySwitchStatus ? PS2_KeyEventBreak_bm : 0));
+                RefDebounce[r][c] = 0;
+            } else if (keySwitchStatus != RefReleased[r][c])
+            {
+                RefReleased[r][c] = keySwitchStatus;
+                RefDebounce[r][c] = DebounceCount;
+            }
+        }
+    }
+}
+
+/*
+ * Benchmark matrix scans, the rows read for each scan
+ */
+#define BenchScans 4096
+#define BenchPasses 64
+static uint8_t BenchRows[BenchScans][MatrixRows];
+static uint32_t BenchRandom = 12345;
+
+static uint32_t benchRandom(void)
+{
+    BenchRandom = BenchRandom * 1103515245UL + 12345;
+    return (BenchRandom >> 16) & 0x7FFF;
+}
+
+/* Typing: key strokes (some rolled over), chattering as pressed and released */
+static void benchTyping(void)
+{
+    unsigned s = 0;
+
+    while (s < BenchScans)
+    {
+        uint8_t p = benchRandom() % (MatrixRows * MatrixCols);
+        unsigned length = 40 + benchRandom() % 60;
+
+        if (!(PS2_KeyValid_bm[KeyPositionRow(p)] & RowCol_bm[KeyPositionCol(p)]))
+            continue;
+        for (unsigned i = 0; (i < length) && (s + i < BenchScans); i++)
+        {
+            bool chatter = (i < 4) || (i >= length - 4);
+
+            if (!chatter || (benchRandom() & 1))
+                BenchRows[s + i][KeyPositionRow(p)] &= ~RowCol_bm[KeyPositionCol(p)];
+        }
+        s += (benchRandom() & 1) ? (length / 2) : (length + 10 + benchRandom() % 50);
+    }
+}
+
+static double benchNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1e9) + now.tv_nsec;
+}
+
+/*
+ * Benchmark a scenario (BenchRows), the de-bounce engine of each full scan:
+ * processKeyboardRow() for every row (and ghostDetect()), against the v3.0
+ * per key de-bounce of every row.
+ */
+static const char *BenchName;
+
+static bool benchScenario(void)
+{
+    double start, engine, reference;
+
+    /* From reset, with the firmware run idle briefly to initialise it */
+    simRun(1000);
+    for (uint8_t r = 0; r < MatrixRows; r++)
+        for (uint8_t c = 0; c < MatrixCols; c++)
+            RefReleased[r][c] = true;
+
+    start = benchNs();
+    for (unsigned pass = 0; pass < BenchPasses; pass++)
+    {
+        for (unsigned s = 0; s < BenchScans; s++)
+        {
+            for (uint8_t r = 0; r < MatrixRows; r++)
+                processKeyboardRow(r, BenchRows[s][r]);
+#if GhostDetect
+            ghostDetect();
+#endif
+            PS2_KeyEventBuffer_Start = PS2_KeyEventBuffer_End;
+        }
+    }
+    engine = (benchNs() - start) / (BenchPasses * BenchScans);
+
+    start = benchNs();
+    for (unsigned pass = 0; pass < BenchPasses; pass++)
+    {
+        for (unsigned s = 0; s < BenchScans; s++)
+        {
+            for (uint8_t r = 0; r < MatrixRows; r++)
+                refKeyboardRow(r, BenchRows[s][r]);
+            RefEvents_Start = RefEvents_End;
+        }
+    }
+    reference = (benchNs() - start) / (BenchPasses * BenchScans);
+
+    printf("  %-8s %14.1f %14.1f %9.1fx\n", BenchName, reference, engine, reference / engine);
+    return true;
+}
+
+static void bench(void)
+{
+    printf("hostsim bench: host ns per Keyboard matrix scan (NOT AVR cycles), DebounceCount %d\n",
+           DebounceCount);
+    printf("  scenario  per key (v3.0)   row at once      ratio\n");
+
+    memset(BenchRows, 0xFF, sizeof(BenchRows));
+    BenchName = "idle";
+    simFork(BenchName, benchScenario);
+
+    for (unsigned s = 0; s < BenchScans; s++)
+        BenchRows[s][KeyPositionRow(9)] &= ~RowCol_bm[KeyPositionCol(9)];
+    BenchName = "held";
+    simFork(BenchName, benchScenario);
+
+    memset(BenchRows, 0xFF, sizeof(BenchRows));
+    benchTyping();
+    BenchName = "typing";
+    simFork(BenchName, benchScenario);
+}
+
+/*
+ * Latency: from a key switch's first contact change, until its Key Event is
+ * queued (de-bounce), and until its first byte is received by the Host, over
+ * LatencyKeys key strokes (each key pressed then released, one at a time, at
+ * times spread across the Keyboard scan).
+ */
+#define LatencyKeys 16
+#define LatencyStrokeUs 20000
+static const uint16_t *LatencyBounce;
+static unsigned LatencyBounceChanges;
+static const char *LatencyName;
+
+typedef struct
+{
+    uint64_t Min, Max, Sum;
+    unsigned Count;
+} LatencyStats_t;
+
+static void latencyAdd(LatencyStats_t *stats, uint64_t clocks)
+{
+    if ((stats->Count == 0) || (clocks < stats->Min)) stats->Min = clocks;
+    if (clocks > stats->Max) stats->Max = clocks;
+    stats->Sum += clocks;
+    stats->Count++;
+}
+
+static void latencyPrint(const char *change, const LatencyStats_t *queued, const LatencyStats_t *sent)
+{
+    printf("  %-8s %-7s %6.0f %6.0f %6.0f   %6.0f %6.0f %6.0f  (%u of %u)\n", LatencyName, change,
+           (double)queued->Min / SimClocksPerUs, (double)queued->Sum / queued->Count / SimClocksPerUs,
+           (double)queued->Max / SimClocksPerUs, (double)sent->Min / SimClocksPerUs,
+           (double)sent->Sum / sent->Count / SimClocksPerUs, (double)sent->Max / SimClocksPerUs,
+           queued->Count, LatencyKeys);
+}
+
+static bool latencyRun(void)
+{
+    LatencyStats_t queued[2] = {{0}}, sent[2] = {{0}};
+    uint8_t positions[LatencyKeys];
+    uint64_t start[LatencyKeys][2];
+    unsigned k = 0;
+
+    for (uint8_t p = 0; k < LatencyKeys; p++)
+    {
+        if (!(PS2_KeyValid_bm[KeyPositionRow(p)] & RowCol_bm[KeyPositionCol(p)]))
+            continue;
+        positions[k] = p;
+        start[k][0] = 1000 + (k * LatencyStrokeUs) + (k * 37);
+        start[k][1] = start[k][0] + (LatencyStrokeUs / 2) + (k * 11);
+        simKey(start[k][0], p, true, LatencyBounce, LatencyBounceChanges);
+        simKey(start[k][1], p, false, LatencyBounce, LatencyBounceChanges);
+        k++;
+    }
+    simRun(1000 + (LatencyKeys * LatencyStrokeUs));
+
+    /* Match each key change to its Key Event, then its first byte sent */
+    for (k = 0; k < LatencyKeys; k++)
+    {
+        for (unsigned change = 0; change < 2; change++)
+        {
+            uint64_t clock = start[k][change] * SimClocksPerUs;
+            uint8_t event = positions[k] | (change ? PS2_KeyEventBreak_bm : 0);
+            unsigned e, b;
+
+            for (e = 0; (e < SimKeyEventCount) && ((SimKeyEvents[e].Clock < clock)
+                                                   || (SimKeyEvents[e].Byte != event)); e++)
+                ;
+            if (e == SimKeyEventCount)
+                continue;
+            for (b = 0; (b < SimHostByteCount) && (SimHostBytes[b].Clock < SimKeyEvents[e].Clock); b++)
+                ;
+            latencyAdd(&queued[change], SimKeyEvents[e].Clock - clock);
+            if (b < SimHostByteCount)
+                latencyAdd(&sent[change], SimHostBytes[b].Clock - clock);
+        }
+    }
+    latencyPrint("press", &queued[0], &sent[0]);
+    latencyPrint("release", &queued[1], &sent[1]);
+    return true;
+}
+
+static void latency(void)
+{
+    printf("hostsim latency: us from first contact change (DebounceCount %d, DebounceEager %d)\n",
+           DebounceCount, DebounceEager);
+    printf("  bounce   change   queued: min   mean    max   at Host: min   mean    max\n");
+
+    LatencyName = "none";
+    LatencyBounce = SimBounceNone;
+    LatencyBounceChanges = sizeof(SimBounceNone) / sizeof(SimBounceNone[0]);
+    simFork(LatencyName, latencyRun);
+
+    LatencyName = "chatter";
+    LatencyBounce = SimBounceChatter;
+    LatencyBounceChanges = sizeof(SimBounceChatter) / sizeof(SimBounceChatter[0]);
+    simFork(LatencyName, latencyRun);
+}
+
+/*
+ * Tests, each run from reset (in its own process)
+ */
+static const struct
+{
+    const char *Name;
+    bool (*Run)(void);
+} Tests[] =
+{
+    {"key tables", testKeyTables},
+    {"every key", testEveryKey},
+    {"commands", testCommands},
+    {"key during command", testKeyDuringCommand},
+    {"reset mid sequence", testResetMidSequence},
+    {"diagnostics debounce", testDiagnosticsDebounce},
+    {"ghost phantom", testGhostPhantom},
+    {"ghost no idle", testGhostNoIdle},
+};
+
+int main(int argc, char *argv[])
+{
+    unsigned failed = 0;
+
+    if ((argc == 2) && !strcmp(argv[1], "bench"))
+    {
+        bench();
+        return 0;
+    }
+    if ((argc == 2) && !strcmp(argv[1], "latency"))
+    {
+        latency();
+        return 0;
+    }
+    if ((argc != 2) || strcmp(argv[1], "test"))
+    {
+        fprintf(stderr, "Usage: %s test | bench | latency\n", argv[0]);
+        return 2;
+    }
+
+    for (unsigned t = 0; t < sizeof(Tests) / sizeof(Tests[0]); t++)
+    {
+        if (simFork(Tests[t].Name, Tests[t].Run))
+            printf("PASS %s\n", Tests[t].Name);
+        else
+            failed++;
+    }
+    return failed ? 1 : 0;
+}
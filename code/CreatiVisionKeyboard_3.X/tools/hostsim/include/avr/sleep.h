@@ -0,0 +1,16 @@
+/*
+ * CreatiVision Keyboard host simulation - avr/sleep.h stand-in
+ * Sleeping runs the simulation's pending interrupts (hostsim.c) instead.
+ */
+#ifndef HOSTSIM_SLEEP_H
+#define HOSTSIM_SLEEP_H
+
+void hostsimSleep(void);
+
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu() hostsimSleep()
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * CreatiVision Keyboard host simulation - MCC system.h stand-in
+ *
+ * Replaces the MCC generated system.h (and the AVR EA device header that it
+ * includes), with just the registers, bits and driver functions that main.c
+ * uses. The registers are modelled by hostsim.c.
+ */
+#ifndef HOSTSIM_SYSTEM_H
+#define HOSTSIM_SYSTEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define F_CPU 20000000UL
+
+/*
+ * I/O Port registers
+ * N.B. DIRSET / DIRCLR / OUTSET / OUTCLR writes are applied (to DIR / OUT),
+ *  and IN is updated, at the next access to any Port.
+ */
+typedef struct
+{
+    uint8_t DIR, DIRSET, DIRCLR, OUT, OUTSET, OUTCLR, IN, INTFLAGS;
+    uint8_t PINCONFIG, PINCTRLUPD, PIN1CTRL;
+} PORT_t;
+
+PORT_t *hostsimPort(uint8_t port);
+#define PORTA (*hostsimPort(0))
+#define PORTD (*hostsimPort(1))
+#define PORTF (*hostsimPort(2))
+
+#define PIN0_bm 0x01
+#define PIN1_bm 0x02
+#define PIN2_bm 0x04
+#define PIN3_bm 0x08
+#define PIN4_bm 0x10
+#define PIN5_bm 0x20
+#define PIN6_bm 0x40
+#define PIN7_bm 0x80
+#define PORT_PULLUPEN_bm 0x08
+#define PORT_ISC_gm 0x07
+#define PORT_ISC_FALLING_gc 0x03
+
+/*
+ * 16 bit Timer / Counter type B registers
+ * N.B. Each access advances the Timer CNT by one tick (TimeBase is 10 ticks
+ *  per us), as time only passes in the simulation as the firmware runs.
+ */
+typedef struct
+{
+    uint8_t CTRLA, CTRLB, INTCTRL, INTFLAGS;
+    uint16_t CNT, CCMP;
+} TCB_t;
+
+TCB_t *hostsimTimer(uint8_t timer);
+#define TCB0 (*hostsimTimer(0))
+#define TCB1 (*hostsimTimer(1))
+
+#define TCB_ENABLE_bm 0x01
+#define TCB_CAPT_bm 0x01
+#define TCB_CNTMODE_INT_gc 0x00
+#define TCB_CLKSEL_DIV2_gc 0x02
+
+/*
+ * 16 bit Timer / Counter type A registers (single mode)
+ * N.B. The PS/2 Timer doesn't run by itself, the simulation calls its ISRs.
+ */
+typedef struct
+{
+    uint8_t CTRLA, INTCTRL, INTFLAGS;
+    uint16_t CNT, PER, PERBUF, CMP0, CMP0BUF;
+} TCA_SINGLE_t;
+
+typedef struct
+{
+    TCA_SINGLE_t SINGLE;
+} TCA_t;
+
+extern TCA_t TCA0;
+
+#define TCA_SINGLE_ENABLE_bm 0x01
+#define TCA_SINGLE_OVF_bm 0x01
+#define TCA_SINGLE_CMP0_bm 0x10
+
+/*
+ * Interrupts (ISRs are plain functions, called by the simulation)
+ */
+#define ISR(vector, ...) void vector(void)
+#define TCA0_OVF_vect_num 9
+
+void hostsimInterrupts(bool enable);
+#define sei() hostsimInterrupts(true)
+#define cli() hostsimInterrupts(false)
+
+/*
+ * MCC driver functions
+ */
+struct TMR_INTERFACE
+{
+    void (*TimeoutCallbackRegister)(void (*callback)(void));
+};
+extern const struct TMR_INTERFACE TCA0_Interface;
+
+void SYSTEM_Initialize(void);
+void IO_PD0_SetInterruptHandler(void (*handler)(void));
+void IO_PD1_SetInterruptHandler(void (*handler)(void));
+void IO_PD2_SetInterruptHandler(void (*handler)(void));
+void IO_PD3_SetInterruptHandler(void (*handler)(void));
+void IO_PD4_SetInterruptHandler(void (*handler)(void));
+void IO_PD5_SetInterruptHandler(void (*handler)(void));
+void IO_PD6_SetInterruptHandler(void (*handler)(void));
+void IO_PD7_SetInterruptHandler(void (*handler)(void));
+void IO_PF1_SetInterruptHandler(void (*handler)(void));
+
+#endif
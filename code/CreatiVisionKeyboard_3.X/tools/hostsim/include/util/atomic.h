@@ -0,0 +1,14 @@
+/*
+ * CreatiVision Keyboard host simulation - util/atomic.h stand-in
+ * (interrupts are disabled for the block, then enabled again)
+ */
+#ifndef HOSTSIM_ATOMIC_H
+#define HOSTSIM_ATOMIC_H
+
+#include "mcc_generated_files/system/system.h"
+
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) \
+    for (bool hostsimAtomic = (cli(), true); hostsimAtomic; hostsimAtomic = (sei(), false))
+
+#endif
@@ -0,0 +1,9 @@
+/*
+ * CreatiVision Keyboard host simulation - util/delay.h stand-in
+ */
+#ifndef HOSTSIM_DELAY_H
+#define HOSTSIM_DELAY_H
+
+#define _delay_us(us)
+
+#endif
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+CreatiVision Keyboard ISR worst case execution time (WCET) check
+----------------------------------------------------------------
+
+Reports the worst (and best) case cycle count of an interrupt vector (ISR)
+in the built image, from its disassembly (avr-objdump -d), using the AVRxt
+(AVR EA / DA series) instruction cycle counts. Functions it calls are
+included. Every path must be bounded, so any loop or indirect jump / call
+fails the check, except an indirect call (icall) to the --callback function
+(e.g. the MCC driver ISR calling its registered callback).
+
+The vector is given as its function (__vector_N), or as the name of an
+absolute symbol set to its vector number (see PS2_TimerVector in main.c).
+The interrupt entry is added to a vector's count (INTERRUPT_ENTRY below),
+as it delays the ISR just the same. N.B. Any time that interrupts are
+disabled (or another ISR is running) delays it further, and isn't counted.
+
+Loads (ld / ldd / lds) take at least one more cycle from flash (mapped into
+the data space, where const data is kept) than from SRAM. An lds from a
+mapped flash address is counted with that extra cycle, and so is every ld /
+ldd, as their address isn't known. N.B. A flash access that waits on the
+NVM controller (only while writing flash / EEPROM) can take longer still.
+
+Fails (exit status 1) if the worst case is over the cycle budget, so a
+timing regression fails the build. Also fails if avr-objdump (or the image)
+can't be found, or the worst case can't be bounded. With --optional, each of
+those is only reported as a warning (exit status 0), as for footprint.py.
+
+Usage: isrwcet.py [--optional] [--callback <function>] <avr-objdump> <budget cycles> <vector> <image.elf or directory>
+"""
+import os
+import re
+import subprocess
+import sys
+
+from buildimage import find_image, run_check
+
+# AVRxt cycle counts (without any branch taken / skip, see below)
+CYCLES = {
+    'adiw': 2, 'sbiw': 2, 'mul': 2, 'muls': 2, 'mulsu': 2,
+    'fmul': 2, 'fmuls': 2, 'fmulsu': 2,
+    'ld': 2, 'ldd': 2, 'lds': 3, 'st': 1, 'std': 1, 'sts': 2,
+    'push': 1, 'pop': 2, 'lpm': 3, 'elpm': 3,
+    'rjmp': 2, 'jmp': 3, 'rcall': 2, 'call': 3, 'icall': 2, 'ret': 4, 'reti': 4,
+}
+SKIPS = ('cpse', 'sbrc', 'sbrs', 'sbic', 'sbis')
+
+# Mapped flash (AVR EA data space addresses), and its extra cycle per load
+FLASH_MAPPED = 0x8000
+FLASH_LOADS = ('ld', 'ldd')
+FLASH_LOAD_CYCLES = 1
+UNBOUNDED = ('ijmp', 'eijmp', 'icall', 'eicall')
+
+# Interrupt entry: response (pushing the PC) 5 cycles, plus the vector's jmp
+# 3 cycles, plus the larger of completing a multi-cycle instruction (up to 3
+# cycles) or waking from sleep (5 cycles)
+INTERRUPT_ENTRY = 5 + 3 + max(3, 5)
+VECTOR = '__vector_'
+
+FUNCTION_LINE = re.compile(r'^([0-9a-f]+) <(.+)>:$')
+INSTRUCTION_LINE = re.compile(r'^\s*([0-9a-f]+):\s+((?:[0-9a-f]{2} )+)\s*(\S+)\s*(.*)$')
+ABSOLUTE_LINE = re.compile(r'^([0-9a-f]+)\s.*\*ABS\*\s+[0-9a-f]+\s+(\S+)$')
+TARGET = re.compile(r';\s*0x([0-9a-f]+)')
+LOAD_ADDRESS = re.compile(r',\s*0x([0-9a-f]+)')
+
+
+def load_cycles(mnemonic, operands):
+    """Extra cycles of a load that may be from mapped flash."""
+    if mnemonic in FLASH_LOADS:
+        return FLASH_LOAD_CYCLES
+    if mnemonic == 'lds':
+        address = LOAD_ADDRESS.search(operands)
+        if (address is None) or ((int(address.group(1), 16) & 0xFFFF) >= FLASH_MAPPED):
+            return FLASH_LOAD_CYCLES
+    return 0
+
+
+def disassemble(objdump, image):
+    """Return ({name: address}, {address: (size, mnemonic, target, cycles)}) of the image."""
+    listing = subprocess.run([objdump, '-d', image], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    functions = {}
+    instructions = {}
+    for line in listing.splitlines():
+        match = FUNCTION_LINE.match(line)
+        if match:
+            functions[match.group(2)] = int(match.group(1), 16)
+            continue
+        match = INSTRUCTION_LINE.match(line)
+        if match:
+            mnemonic = match.group(3)
+            target = TARGET.search(match.group(4))
+            instructions[int(match.group(1), 16)] = (
+                len(match.group(2).split()), mnemonic,
+                int(target.group(1), 16) if target else None,
+                CYCLES.get(mnemonic, 1) + load_cycles(mnemonic, match.group(4)))
+    return functions, instructions
+
+
+def absolute_symbols(objdump, image):
+    """Return {name: value} of the image's absolute symbols."""
+    listing = subprocess.run([objdump, '-t', image], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return {match.group(2): int(match.group(1), 16)
+            for match in map(ABSOLUTE_LINE.match, listing.splitlines()) if match}
+
+
+class Analysis:
+    def __init__(self, functions, instructions, callback=None):
+        self.names = {address: name for name, address in functions.items()}
+        self.callback = functions.get(callback)
+        self.callback_name = callback
+        self.instructions = instructions
+        self.functions = {}
+        self.paths = {}
+
+    def name(self, address):
+        return self.names.get(address, '0x%x' % address)
+
+    def function(self, address):
+        """(best, worst) cycles from a function entry point to its return."""
+        if address not in self.functions:
+            self.functions[address] = None
+            self.functions[address] = self.path(address, address, ())
+        if self.functions[address] is None:
+            sys.exit('isrwcet: %s is recursive (unbounded)' % self.name(address))
+        return self.functions[address]
+
+    def path(self, function, address, visiting):
+        """(best, worst) cycles from address to the function return."""
+        key = (function, address)
+        if key in self.paths:
+            return self.paths[key]
+        if address in visiting:
+            sys.exit('isrwcet: %s has a loop at 0x%x (unbounded)' % (self.name(function), address))
+        if address not in self.instructions:
+            sys.exit('isrwcet: %s runs into 0x%x (not code)' % (self.name(function), address))
+        visiting = visiting + (address,)
+
+        size, mnemonic, target, cycles = self.instructions[address]
+        following = address + size
+
+        if (mnemonic == 'icall') and (self.callback_name is not None):
+            if self.callback is None:
+                sys.exit('isrwcet: %s calls %s (icall at 0x%x), which is not found'
+                         % (self.name(function), self.callback_name, address))
+            called = self.function(self.callback)
+            best, worst = self.path(function, following, visiting)
+            result = (cycles + called[0] + best, cycles + called[1] + worst)
+            self.paths[key] = result
+            return result
+        if mnemonic in UNBOUNDED:
+            sys.exit('isrwcet: %s has an indirect %s at 0x%x (unbounded)'
+                     % (self.name(function), mnemonic, address))
+        if mnemonic in ('ret', 'reti'):
+            result = (cycles, cycles)
+        elif mnemonic in ('rjmp', 'jmp'):
+            best, worst = self.path(function, target, visiting)
+            result = (cycles + best, cycles + worst)
+        elif mnemonic in ('rcall', 'call'):
+            called = self.function(target)
+            best, worst = self.path(function, following, visiting)
+            result = (cycles + called[0] + best, cycles + called[1] + worst)
+        elif mnemonic.startswith('br'):
+            taken = self.path(function, target, visiting)
+            not_taken = self.path(function, following, visiting)
+            result = (cycles + min(taken[0] + 1, not_taken[0]),
+                      cycles + max(taken[1] + 1, not_taken[1]))
+        elif mnemonic in SKIPS:
+            skipped_size = self.instructions[following][0]
+            skipped = self.path(function, following + skipped_size, visiting)
+            not_skipped = self.path(function, following, visiting)
+            extra = 1 if skipped_size == 2 else 2
+            result = (cycles + min(skipped[0] + extra, not_skipped[0]),
+                      cycles + max(skipped[1] + extra, not_skipped[1]))
+        else:
+            best, worst = self.path(function, following, visiting)
+            result = (cycles + best, cycles + worst)
+
+        self.paths[key] = result
+        return result
+
+
+def check(arguments):
+    """Run the check, exiting with the reason if it fails."""
+    callback = None
+    if '--callback' in arguments[:-1]:
+        index = arguments.index('--callback')
+        callback = arguments[index + 1]
+        del arguments[index:index + 2]
+    if len(arguments) != 4:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        sys.exit(2)
+    objdump, budget, function, path = arguments[0], int(arguments[1]), arguments[2], arguments[3]
+
+    image = find_image(path)
+    if image is None:
+        sys.exit('isrwcet: no image found in %s, not checked' % path)
+    try:
+        functions, instructions = disassemble(objdump, image)
+    except OSError:
+        sys.exit('isrwcet: %s not found, not checked' % objdump)
+    if function not in functions:
+        vector = absolute_symbols(objdump, image).get(function)
+        if vector is None:
+            sys.exit('isrwcet: %s not found in %s' % (function, image))
+        function = VECTOR + str(vector)
+        if function not in functions:
+            sys.exit('isrwcet: %s (vector) not found in %s' % (function, image))
+
+    sys.setrecursionlimit(10000)
+    analysis = Analysis(functions, instructions, callback)
+    best, worst = analysis.function(functions[function])
+    entry = INTERRUPT_ENTRY if function.startswith(VECTOR) else 0
+    best, worst = best + entry, worst + entry
+    print('isrwcet: %s (%s) best case %d cycles, worst case %d cycles (budget %d, including %d cycles interrupt entry)'
+          % (function, os.path.basename(image), best, worst, budget, entry))
+    if worst > budget:
+        sys.exit('isrwcet: %s worst case %d cycles is OVER budget (%d cycles)!'
+                 % (function, worst, budget))
+
+
+if __name__ == '__main__':
+    run_check(check)
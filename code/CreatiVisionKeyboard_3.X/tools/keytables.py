@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+CreatiVision Keyboard key table generator
+-----------------------------------------
+
+Generates keytables.h (the PS/2 key tables used by main.c) from the
+Keyboard key layout description (keylayout.txt).
+
+For each Keyboard matrix Row / Column position, the full PS/2 byte
+sequences sent on key make (press) and break (release) are generated,
+so that main.c only needs a table lookup (and no Scan Code checks).
+
+Usage: keytables.py <keylayout.txt> <keytables.h>
+"""
+import sys
+
+MATRIX_ROWS = 8
+MATRIX_COLS = 8
+
+EXTENDED_SCAN_CODE = 0xE0
+RELEASE_SCAN_CODE = 0xF0
+
+# Longest make / break sequences (E0 xx / E0 F0 xx), plus the length byte
+MAKE_SIZE = 1 + 2
+BREAK_SIZE = 1 + 3
+
+
+def parse_layout(path):
+    """Return {(row, col): (extended, scan_code, name)} from the layout file."""
+    keys = {}
+    with open(path) as layout:
+        for line_number, line in enumerate(layout, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            where = '%s:%d' % (path, line_number)
+            fields = line.split()
+            if len(fields) < 3:
+                sys.exit('%s: expected "Row Column Scan Code [Key name]"' % where)
+
+            row, col = int(fields[0]), int(fields[1])
+            if not (0 <= row < MATRIX_ROWS and 0 <= col < MATRIX_COLS):
+                sys.exit('%s: Row / Column is outside the matrix' % where)
+            if (row, col) in keys:
+                sys.exit('%s: Row %d Column %d is already defined' % (where, row, col))
+
+            extended = (int(fields[2], 16) == EXTENDED_SCAN_CODE)
+            code_field = 3 if extended else 2
+            if len(fields) <= code_field:
+                sys.exit('%s: missing Scan Code after E0' % where)
+            scan_code = int(fields[code_field], 16)
+            if not (0x01 <= scan_code <= 0xFF) or scan_code in (EXTENDED_SCAN_CODE, RELEASE_SCAN_CODE):
+                sys.exit('%s: invalid Scan Code' % where)
+
+            keys[(row, col)] = (extended, scan_code, ' '.join(fields[code_field + 1:]))
+    return keys
+
+
+def sequence(codes, size):
+    """C initializer for a length prefixed byte sequence, padded to size."""
+    padded = [len(codes)] + codes + [0] * (size - 1 - len(codes))
+    return '{' + ','.join('0x%02X' % code for code in padded) + '}'
+
+
+def generate(keys, layout_name):
+    out = []
+    out.append('/*')
+    out.append(' * CreatiVision Keyboard key tables')
+    out.append(' * ')
+    out.append(' * GENERATED by tools/keytables.py from %s - DO NOT EDIT!' % layout_name)
+    out.append(' * ')
+    out.append(' * Included by main.c (after MatrixRows / MatrixCols are defined).')
+    out.append(' */')
+    out.append('')
+
+    out.append('/*')
+    out.append(' * PS/2 make (key press) and break (key release) sequences for each')
+    out.append(' * Keyboard matrix Row / Column. First byte is the sequence length')
+    out.append(' * (0 if there is no key switch), followed by the bytes to send.')
+    out.append(' */')
+    out.append('#define PS2_KeyMake_Size %d' % MAKE_SIZE)
+    out.append('#define PS2_KeyBreak_Size %d' % BREAK_SIZE)
+    out.append('')
+
+    for table, size, is_break in (('PS2_KeyMake', 'PS2_KeyMake_Size', False),
+                                  ('PS2_KeyBreak', 'PS2_KeyBreak_Size', True)):
+        out.append('static const uint8_t %s[MatrixRows][MatrixCols][%s]' % (table, size))
+        rows = []
+        for row in range(MATRIX_ROWS):
+            cols = []
+            for col in range(MATRIX_COLS):
+                codes = []
+                if (row, col) in keys:
+                    extended, scan_code, _ = keys[(row, col)]
+                    if extended:
+                        codes.append(EXTENDED_SCAN_CODE)
+                    if is_break:
+                        codes.append(RELEASE_SCAN_CODE)
+                    codes.append(scan_code)
+                cols.append(sequence(codes, BREAK_SIZE if is_break else MAKE_SIZE))
+            rows.append('{' + ','.join(cols) + '}')
+        out.append('                        = {' + (',\n                           '.join(rows)) + '};')
+        out.append('')
+
+    out.append('/*')
+    out.append(' * Key switches fitted (valid keys), bit mask of columns for each row.')
+    out.append(' */')
+    out.append('static const uint8_t PS2_KeyValid_bm[MatrixRows]')
+    out.append('                        = {' + column_masks(keys, lambda key: True) + '};')
+    out.append('')
+
+    out.append('/*')
+    out.append(' * PS2_KeyCount = the number of key switches fitted.')
+    out.append(' * PS2_KeyIndex = a key number (0 to PS2_KeyCount - 1) for each key matrix')
+    out.append(' * Row / Column (or 0xFF if no key switch), for per key tables.')
+    out.append(' */')
+    out.append('#define PS2_KeyCount %d' % len(keys))
+    out.append('')
+    out.append('static const uint8_t PS2_KeyIndex[MatrixRows][MatrixCols]')
+    rows = []
+    index = 0
+    for row in range(MATRIX_ROWS):
+        cols = []
+        for col in range(MATRIX_COLS):
+            if (row, col) in keys:
+                cols.append('%4d' % index)
+                index += 1
+            else:
+                cols.append('0xFF')
+        rows.append('{' + ','.join(cols) + '}')
+    out.append('                        = {' + (',\n                           '.join(rows)) + '};')
+    out.append('')
+    return '\n'.join(out)
+
+
+def column_masks(keys, selected):
+    """C initializer values of the column bit mask of selected keys, per row."""
+    masks = []
+    for row in range(MATRIX_ROWS):
+        mask = 0
+        for col in range(MATRIX_COLS):
+            if (row, col) in keys and selected(keys[(row, col)]):
+                mask |= 1 << col
+        masks.append('0x%02X' % mask)
+    return ','.join(masks)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    layout_path, header_path = sys.argv[1], sys.argv[2]
+    header = generate(parse_layout(layout_path), layout_path.replace('\\', '/').split('/')[-1])
+    with open(header_path, 'w', newline='\n') as out:
+        out.write(header)
+
+
+if __name__ == '__main__':
+    main()